@@ -0,0 +1,490 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Filter.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+// Every SAMPLE_RATE lines, all rules of a step are evaluated and timed, and
+// every REORDER_RATE lines the steps are reordered from those samples.
+static const unsigned long SAMPLE_RATE  = 64;
+static const unsigned long REORDER_RATE = 64 * SAMPLE_RATE;
+
+////////////////////////////////////////////////////////////////////////////////
+Filter::Filter (
+  std::vector <Rule>& rules,
+  const std::vector <std::string>& sections)
+: _rules (rules)
+, _sections (sections)
+{
+  // Use a default section if one was not specified.
+  if (_sections.size () == 0)
+    _sections.push_back ("default");
+
+  _watched.assign (_rules.size (), 0);
+  _hits.assign (_rules.size (), 0);
+  context (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Filter::prependDate (bool value)
+{
+  _date = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Filter::prependTime (bool value)
+{
+  _time = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Identifies the source of the line, when several are merged.
+void Filter::tag (const std::string& value)
+{
+  _tag = value.length () ? value + ' ' : "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Lets apply leave a whole line that it would output unchanged to the caller,
+// which can copy it straight from the input.
+void Filter::passthrough (bool value)
+{
+  _passthrough = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Gives lines of context to the rules that color lines and do not specify
+// their own, and unless told otherwise, their own to those that do.  The
+// rules with context are watched, to see which hit a line.
+void Filter::context (int lines, bool own)
+{
+  _designated.clear ();
+  _around.assign (_rules.size (), 0);
+
+  int most = 0;
+  for (std::size_t i = 0; i < _rules.size (); ++i)
+  {
+    auto& rule = _rules[i];
+    if (rule._around >= 0)
+      _around[i] = own ? rule._around : 0;
+    else if (rule._context != Rule::Context::suppress &&
+             rule._context != Rule::Context::blank    &&
+             rule._context != Rule::Context::none)
+      _around[i] = lines;
+
+    if (_around[i] > 0)
+      _designated.push_back (i);
+
+    most = std::max (most, _around[i]);
+  }
+
+  _history.resize (most);
+  _after = 0;
+  watch (_designated);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Lists the rules of all the sections specified, in sequence.  Within a run of
+// consecutive suppress and blank rules, the order does not matter: suppress
+// rules only clear the layers, blank rules only set the blanks flag, and each
+// is idempotent.  So the suppress rules of such a run form one step that can
+// stop at the first hit, and the blank rules another.  Every other rule is a
+// step of its own, evaluated in order, as is a final rule of any kind, which
+// ends evaluation where it hits.
+void Filter::plan ()
+{
+  _plan.clear ();
+  _candidates.clear ();
+
+  std::vector <std::size_t> suppress;
+  std::vector <std::size_t> blank;
+  std::vector <std::size_t> single;
+  for (const auto& section : _sections)
+  {
+    auto id = Rule::intern (section);
+    for (std::size_t i = 0; i < _rules.size (); ++i)
+    {
+      auto& rule = _rules[i];
+      if (rule._sectionId != id)
+        continue;
+
+      if (rule._context == Rule::Context::suppress && ! rule._final)
+        suppress.push_back (i);
+      else if (rule._context == Rule::Context::blank && ! rule._final)
+        blank.push_back (i);
+      else
+      {
+        step (suppress, true);
+        step (blank, true);
+        single.push_back (i);
+        step (single, false);
+      }
+    }
+  }
+
+  step (suppress, true);
+  step (blank, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends a step of the rules, by index, if there are any, and empties the
+// list.
+void Filter::step (std::vector <std::size_t>& indexes, bool any)
+{
+  if (indexes.size () == 0)
+    return;
+
+  Step step {_candidates.size (), 0, any, false};
+  for (auto index : indexes)
+  {
+    auto& rule = _rules[index];
+    _candidates.push_back ({rule.compiled (), &rule, (unsigned int) index, rule._final, 0, 0});
+    if (_watching && _watched[index])
+      step._watched = true;
+  }
+
+  step._end = _candidates.size ();
+  _plan.push_back (step);
+  indexes.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Records whether the rules, by index, hit each line, in addition to those
+// already watched.  A step that holds one of them no longer stops at its first
+// hit.
+void Filter::watch (const std::vector <std::size_t>& indexes)
+{
+  for (auto index : indexes)
+    _watched[index] = 1;
+
+  _watching = _watching || indexes.size () > 0;
+  plan ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether the watched rule, by index, hit the last line.
+bool Filter::hit (std::size_t index) const
+{
+  return _hits[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Applies all the rules in all the sections specified.
+// Note that processing does not stop after the first rule match, it keeps
+// going, except within a step of order-independent rules, which has nothing
+// left to decide after its first hit, and after a final rule hits.
+void Filter::applyRules (bool& blanks, const std::string& line)
+{
+  _layers.add (0, line.length (), {0});
+
+  if (_watching)
+    std::fill (_hits.begin (), _hits.end (), 0);
+
+  bool sample = ++_lines % SAMPLE_RATE == 0;
+  auto candidates = _candidates.data ();
+  for (auto& step : _plan)
+  {
+    auto begin = candidates + step._begin;
+    auto end   = candidates + step._end;
+    if (! step._any)
+    {
+      if (begin->_kernel (*begin->_rule, _scratch, _layers, blanks, line))
+      {
+        if (_watching)
+          _hits[begin->_index] = 1;
+
+        if (begin->_final)
+          break;
+      }
+    }
+
+    else if (step._watched)
+    {
+      for (auto candidate = begin; candidate != end; ++candidate)
+        if (candidate->_kernel (*candidate->_rule, _scratch, _layers, blanks, line))
+          _hits[candidate->_index] = 1;
+    }
+
+    else if (! sample)
+    {
+      for (auto candidate = begin; candidate != end; ++candidate)
+        if (candidate->_kernel (*candidate->_rule, _scratch, _layers, blanks, line))
+          break;
+    }
+
+    // Sampled lines evaluate every candidate, so the hit rates are not biased
+    // by the current order.
+    else
+    {
+      for (auto candidate = begin; candidate != end; ++candidate)
+      {
+        auto start = std::chrono::steady_clock::now ();
+        if (candidate->_kernel (*candidate->_rule, _scratch, _layers, blanks, line))
+          ++candidate->_hits;
+
+        candidate->_nanoseconds += std::chrono::duration_cast <std::chrono::nanoseconds> (
+                                     std::chrono::steady_clock::now () - start).count ();
+      }
+    }
+  }
+
+  if (_lines % REORDER_RATE == 0)
+    reorder ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Compares hits per nanosecond, without dividing.
+bool Filter::better (const Candidate& left, const Candidate& right)
+{
+  return (double) left._hits  * (right._nanoseconds + 1) >
+         (double) right._hits * (left._nanoseconds  + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Puts the rules most likely to decide a step, for the least cost, first.  The
+// counts are then halved, so that the order follows changes in the input.
+void Filter::reorder ()
+{
+  for (auto& step : _plan)
+  {
+    if (! step._any)
+      continue;
+
+    // An insertion sort, because it is stable and needs no storage, which
+    // std::stable_sort does.
+    auto candidates = _candidates.data ();
+    for (auto i = step._begin + 1; i < step._end; ++i)
+    {
+      auto candidate = candidates[i];
+      auto j = i;
+      for (; j > step._begin && better (candidate, candidates[j - 1]); --j)
+        candidates[j] = candidates[j - 1];
+
+      candidates[j] = candidate;
+    }
+
+    for (auto i = step._begin; i < step._end; ++i)
+    {
+      candidates[i]._hits /= 2;
+      candidates[i]._nanoseconds /= 2;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders one input line, without its \n, and appends the result to output.
+// A suppressed line appends nothing.  No storage is allocated per line, the
+// output is rendered in place, and should be reused by the caller.
+void Filter::apply (const std::string& line, std::string& output)
+{
+  apply (line, output, 0, std::string::npos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders one segment of a long line.  The first overlap bytes repeat the end
+// of the previous segment, so that rules see patterns spanning the boundary,
+// but they were already rendered.  If the line continues, rendering stops at
+// the cut, and the next segment renders the rest.  Only the first visible
+// segment is prefixed, and only the last one is terminated.
+void Filter::apply (
+  const std::string& line,
+  std::string& output,
+  std::string::size_type overlap,
+  std::string::size_type cut)
+{
+  apply (line, output, nullptr, overlap, cut);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders as above, and if plain is given, appends the same lines to it
+// without colors.  With passthrough, returns true instead of rendering a whole
+// line that no rule changed, which the caller then outputs as it is.
+bool Filter::apply (
+  const std::string& line,
+  std::string& output,
+  std::string* plain,
+  std::string::size_type overlap,
+  std::string::size_type cut)
+{
+  bool blanks = false;
+  applyRules (blanks, line);
+
+  // Context is a matter of whole lines.  A hit shows the hidden lines before
+  // it, and the hidden lines after it are shown instead of suppressed.
+  bool shown = false;
+  if (_designated.size () && overlap == 0 && cut == std::string::npos)
+  {
+    int around = 0;
+    for (auto index : _designated)
+      if (_hits[index])
+        around = std::max (around, _around[index]);
+
+    bool hidden = line.length () && _layers.width () == 0;
+    if (around)
+    {
+      // The ring holds as many lines as the widest context, so a narrower one
+      // shows only the most recent of them.
+      auto first = _history.size () - std::min <std::size_t> (around, _history.size ());
+      for (auto i = first; i < _history.size (); ++i)
+      {
+        auto held = _history.hidden (i);
+        if (held)
+        {
+          show (*held, output, plain);
+          shown = true;
+        }
+      }
+
+      _history.clear ();
+      _after = std::max (_after, around);
+    }
+    else if (_after && hidden)
+    {
+      show (line, output, plain);
+      _layers.clear ();
+      --_after;
+      _history.add (line, false);
+      return false;
+    }
+    else if (_after)
+      --_after;
+
+    _history.add (line, hidden);
+  }
+
+  if (_passthrough                   &&
+      ! shown                        &&
+      ! blanks                       &&
+      overlap == 0                   &&
+      cut == std::string::npos       &&
+      ! _open                        &&
+      ! _date                        &&
+      ! _time                        &&
+      _tag == ""                     &&
+      _layers.bare (line.length ()))
+  {
+    _layers.clear ();
+    return true;
+  }
+
+  if (blanks)
+  {
+    if (! _open && ! _trailing)
+    {
+      output += '\n';
+      if (plain)
+        *plain += '\n';
+    }
+
+    _trailing = true;
+  }
+
+  if (std::min (_layers.width (), cut) > overlap || (line.length () == 0 && ! _open))
+  {
+    if (! _open)
+    {
+      auto length = output.length ();
+      prefix (output);
+      if (plain)
+        plain->append (output, length, std::string::npos);
+    }
+
+    _layers.render (line, output, overlap, cut);
+    if (plain)
+      _layers.plain (line, *plain, overlap, cut);
+
+    _open = true;
+  }
+
+  if (cut == std::string::npos)
+  {
+    if (_open)
+      output += '\n';
+
+    if (_trailing)
+      output += '\n';
+
+    if (plain)
+    {
+      if (_open)
+        *plain += '\n';
+
+      if (_trailing)
+        *plain += '\n';
+    }
+
+    _open = false;
+    _trailing = false;
+  }
+
+  _layers.clear ();
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Outputs a hidden line as it is, for context.
+void Filter::show (const std::string& line, std::string& output, std::string* plain)
+{
+  auto length = output.length ();
+  prefix (output);
+  output += line;
+  output += '\n';
+  if (plain)
+    plain->append (output, length, std::string::npos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Filter::prefix (std::string& output)
+{
+  if (_date || _time)
+  {
+    time_t current;
+    time (&current);
+    struct tm* t = localtime (&current);
+
+    char stamp[32];
+    if (_date)
+    {
+      snprintf (stamp, sizeof (stamp), "%d-%02d-%02d ", t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+      output += stamp;
+    }
+
+    if (_time)
+    {
+      snprintf (stamp, sizeof (stamp), "%02d:%02d:%02d ", t->tm_hour, t->tm_min, t->tm_sec);
+      output += stamp;
+    }
+  }
+
+  output += _tag;
+}
+
+////////////////////////////////////////////////////////////////////////////////
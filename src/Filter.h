@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_FILTER
+#define INCLUDED_FILTER
+
+#include <string>
+#include <vector>
+#include <Rule.h>
+#include <Layers.h>
+#include <History.h>
+
+// A Filter applies a shared set of rules, restricted to a list of sections, to
+// one stream of input lines.  Several filters may share the same rules, which
+// is how the daemon serves many clients from one compiled rule set.  A line
+// may be rendered with and without colors at once, and whether watched rules
+// hit it is recorded, so that one evaluation feeds several outputs.  Around a
+// line hit by a rule with context, hidden lines are shown, as with grep -C.
+class Filter
+{
+public:
+  Filter (std::vector <Rule>&, const std::vector <std::string>&);
+  void prependDate (bool);
+  void prependTime (bool);
+  void tag (const std::string&);
+  void passthrough (bool);
+  void context (int, bool = true);
+  void watch (const std::vector <std::size_t>&);
+  bool hit (std::size_t) const;
+  void apply (const std::string&, std::string&);
+  void apply (const std::string&, std::string&, std::string::size_type, std::string::size_type);
+  bool apply (const std::string&, std::string&, std::string*, std::string::size_type, std::string::size_type);
+
+private:
+  // A rule as the plan applies it: its kernel, and what is read with it.
+  // The candidates of all steps are held in one array, in plan order.
+  struct Candidate
+  {
+    Rule::Kernel  _kernel;
+    const Rule*   _rule;
+    unsigned int  _index;        // In the rule set
+    bool          _final;
+    unsigned long _hits;
+    unsigned long _nanoseconds;
+  };
+
+  // Rules in one step are evaluated until the first hit, which is only valid
+  // for rules whose order does not affect the output.  Such a step is
+  // reordered by observed hits per nanosecond.
+  struct Step
+  {
+    std::size_t _begin;          // Candidates [_begin, _end)
+    std::size_t _end;
+    bool        _any;
+    bool        _watched;
+  };
+
+  void plan ();
+  void step (std::vector <std::size_t>&, bool);
+  void applyRules (bool&, const std::string&);
+  void reorder ();
+  void prefix (std::string&);
+  void show (const std::string&, std::string&, std::string*);
+  static bool better (const Candidate&, const Candidate&);
+
+private:
+  std::vector <Rule>&       _rules;
+  std::vector <std::string> _sections  {};
+  std::vector <Step>        _plan      {};
+  std::vector <Candidate>   _candidates {};
+  Rule::Scratch             _scratch   {};
+  unsigned long             _lines     {0};
+  bool                      _date      {false};
+  bool                      _time      {false};
+  std::string               _tag       {};
+  Layers                    _layers    {};
+  std::vector <char>        _watched   {};  // By rule index
+  std::vector <char>        _hits      {};  // Of watched rules, this line
+  bool                      _watching  {false};
+  bool                      _open      {false};
+  bool                      _trailing  {false};
+  bool                      _passthrough {false};
+  std::vector <std::size_t> _designated {};  // Rules with context, by index
+  std::vector <int>         _around    {};  // Lines of context, by rule index
+  History                   _history   {};
+  int                       _after     {0};  // Lines still to show after a hit
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Fold.h>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+static inline unsigned char fold (unsigned char c)
+{
+  return (unsigned char) (c - 'A') < 26 ? c | 0x20 : c;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string foldCase (const std::string& input)
+{
+  std::string output (input);
+  for (auto& c : output)
+    c = fold (c);
+
+  return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Compares text with an already folded pattern.
+bool equalFolded (const char* text, const char* folded, std::string::size_type length)
+{
+  for (std::string::size_type i = 0; i < length; ++i)
+    if (fold (text[i]) != (unsigned char) folded[i])
+      return false;
+
+  return true;
+}
+
+#ifdef __SSE2__
+////////////////////////////////////////////////////////////////////////////////
+// Folds sixteen bytes: 'A'..'Z' are shifted to the bottom of the signed range
+// so that a single signed compare selects them, and then get the 0x20 bit.
+static inline __m128i fold16 (__m128i bytes)
+{
+  auto shifted = _mm_add_epi8 (bytes, _mm_set1_epi8 ((char) (0x80 - 'A')));
+  auto upper   = _mm_cmplt_epi8 (shifted, _mm_set1_epi8 ((char) (0x80 + 26)));
+  return _mm_or_si128 (bytes, _mm_and_si128 (upper, _mm_set1_epi8 (0x20)));
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Finds the folded pattern in text, at or after from.  Candidates are positions
+// where both the first and the last byte of the pattern match, which rejects
+// almost every position sixteen at a time, and only those are compared in
+// full.
+std::string::size_type findFolded (
+  const std::string& text,
+  const std::string& folded,
+  std::string::size_type from)
+{
+  auto length = folded.length ();
+  if (length == 0)
+    return from <= text.length () ? from : std::string::npos;
+
+  if (from >= text.length () || text.length () - from < length)
+    return std::string::npos;
+
+  auto data  = text.data ();
+  auto last  = text.length () - length;      // Last possible start
+  auto first = (unsigned char) folded[0];
+  auto final = (unsigned char) folded[length - 1];
+  auto pos   = from;
+
+#ifdef __SSE2__
+  auto firsts = _mm_set1_epi8 ((char) first);
+  auto finals = _mm_set1_epi8 ((char) final);
+  for (; pos + 16 <= last + 1; pos += 16)
+  {
+    auto head = fold16 (_mm_loadu_si128 ((const __m128i*) (data + pos)));
+    auto tail = fold16 (_mm_loadu_si128 ((const __m128i*) (data + pos + length - 1)));
+    auto mask = (unsigned) _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (head, firsts),
+                                                             _mm_cmpeq_epi8 (tail, finals)));
+    while (mask)
+    {
+      auto bit = __builtin_ctz (mask);
+      if (equalFolded (data + pos + bit + 1, folded.data () + 1, length - 1))
+        return pos + bit;
+
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  for (; pos <= last; ++pos)
+    if (fold (data[pos]) == first &&
+        fold (data[pos + length - 1]) == final &&
+        equalFolded (data + pos + 1, folded.data () + 1, length - 1))
+      return pos;
+
+  return std::string::npos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
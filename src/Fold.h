@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_FOLD
+#define INCLUDED_FOLD
+
+#include <string>
+
+// ASCII case-insensitive search.  The pattern is folded to lower case once,
+// and the text is folded on the fly, sixteen bytes at a time where SSE2 is
+// available, so that no lowercased copy of a line is ever made.
+std::string foldCase (const std::string&);
+bool equalFolded (const char*, const char*, std::string::size_type);
+std::string::size_type findFolded (const std::string&, const std::string&, std::string::size_type);
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
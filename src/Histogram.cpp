@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Histogram.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Records count occurrences of the value.
+void Histogram::record (std::uint64_t value, std::uint64_t count)
+{
+  _counts[bucket (value)] += count;
+  _count += count;
+  if (value > _max)
+    _max = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::uint64_t Histogram::count () const
+{
+  return _count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The upper bound of the bucket holding the value at quantile q, but no more
+// than the largest value recorded.
+std::uint64_t Histogram::quantile (double q) const
+{
+  if (_count == 0)
+    return 0;
+
+  auto rank = (std::uint64_t) (q * _count);
+  if (rank >= _count)
+    rank = _count - 1;
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < BUCKETS; ++i)
+  {
+    seen += _counts[i];
+    if (seen > rank)
+    {
+      auto upper = i + 1 < BUCKETS ? lowest (i + 1) - 1 : _max;
+      return upper < _max ? upper : _max;
+    }
+  }
+
+  return _max;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::uint64_t Histogram::max () const
+{
+  return _max;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Values below 16 have a bucket each.  Above that, a value with its highest
+// bit at position e falls in one of the 16 buckets that divide [2^e, 2^e+1).
+std::size_t Histogram::bucket (std::uint64_t value)
+{
+  if (value < SUB)
+    return value;
+
+  std::size_t e = 63 - __builtin_clzll (value);
+  return (e - 3) * SUB + ((value >> (e - 4)) & (SUB - 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The smallest value that falls in the bucket.
+std::uint64_t Histogram::lowest (std::size_t index)
+{
+  if (index < SUB)
+    return index;
+
+  std::size_t e = index / SUB + 3;
+  return (std::uint64_t) (SUB + index % SUB) << (e - 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends text to what fills length bytes of buffer, within its size, and
+// returns the new length.
+std::size_t Histogram::append (char* buffer, std::size_t size, std::size_t length, const char* text)
+{
+  while (*text && length < size)
+    buffer[length++] = *text++;
+
+  return length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends a number in decimal, likewise.
+std::size_t Histogram::append (char* buffer, std::size_t size, std::size_t length, std::uint64_t number)
+{
+  char digits[24];
+  std::size_t count = 0;
+  do
+  {
+    digits[count++] = '0' + number % 10;
+    number /= 10;
+  }
+  while (number);
+
+  while (count && length < size)
+    buffer[length++] = digits[--count];
+
+  return length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Nanoseconds, as microseconds to one decimal.
+static std::size_t micro (char* buffer, std::size_t size, std::size_t length, std::uint64_t value)
+{
+  length = Histogram::append (buffer, size, length, value / 1000);
+  length = Histogram::append (buffer, size, length, ".");
+  length = Histogram::append (buffer, size, length, value / 100 % 10);
+  return Histogram::append (buffer, size, length, "us");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes a line such as:
+//   lines 1200, p50 3.1us, p99 12.0us, p99.9 40.9us, max 1310.7us
+// into buffer, and returns its length.
+std::size_t Histogram::format (char* buffer, std::size_t size) const
+{
+  std::size_t length = 0;
+  length = append (buffer, size, length, "lines ");
+  length = append (buffer, size, length, _count);
+  length = append (buffer, size, length, ", p50 ");
+  length = micro  (buffer, size, length, quantile (0.5));
+  length = append (buffer, size, length, ", p99 ");
+  length = micro  (buffer, size, length, quantile (0.99));
+  length = append (buffer, size, length, ", p99.9 ");
+  length = micro  (buffer, size, length, quantile (0.999));
+  length = append (buffer, size, length, ", max ");
+  length = micro  (buffer, size, length, _max);
+  return append (buffer, size, length, "\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_HISTOGRAM
+#define INCLUDED_HISTOGRAM
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts durations in nanoseconds, in log-linear buckets: sixteen linear
+// buckets for each power of two, which bounds the error of any quantile to
+// about 6%, in a fixed array, so that recording is a few instructions and
+// never allocates.  Formatting also does not allocate, so that it is safe in a
+// signal handler.
+class Histogram
+{
+public:
+  void record (std::uint64_t, std::uint64_t = 1);
+  std::uint64_t count () const;
+  std::uint64_t quantile (double) const;
+  std::uint64_t max () const;
+  std::size_t format (char*, std::size_t) const;
+
+  static std::size_t bucket (std::uint64_t);
+  static std::uint64_t lowest (std::size_t);
+  static std::size_t append (char*, std::size_t, std::size_t, const char*);
+  static std::size_t append (char*, std::size_t, std::size_t, std::uint64_t);
+
+private:
+  static const std::size_t SUB     = 16;
+  static const std::size_t BUCKETS = (64 - 3) * SUB;
+
+  std::uint64_t _counts[BUCKETS] {};
+  std::uint64_t _count           {0};
+  std::uint64_t _max             {0};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
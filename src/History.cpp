@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <History.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Sets how many lines are held, and forgets those held.
+void History::resize (std::size_t lines)
+{
+  _lines.resize (lines);
+  _hidden.assign (lines, 0);
+  clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t History::capacity () const
+{
+  return _lines.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A line that was shown only takes its place, so that it counts as context
+// but is not shown again.
+void History::add (const std::string& line, bool hidden)
+{
+  if (_lines.size () == 0)
+    return;
+
+  if (hidden)
+    _lines[_next].assign (line);
+
+  _hidden[_next] = hidden;
+  _next = (_next + 1) % _lines.size ();
+  if (_size < _lines.size ())
+    ++_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t History::size () const
+{
+  return _size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The line held at index, oldest first, if it was hidden, otherwise nullptr.
+const std::string* History::hidden (std::size_t index) const
+{
+  auto slot = (_next + _lines.size () - _size + index) % _lines.size ();
+  return _hidden[slot] ? &_lines[slot] : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void History::clear ()
+{
+  _next = 0;
+  _size = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_HISTORY
+#define INCLUDED_HISTORY
+
+#include <string>
+#include <vector>
+
+// The last few input lines, in a ring of fixed size, for showing the context
+// of a line.  Only hidden lines are copied, into slots that keep their storage,
+// so that once warmed up, adding a line allocates nothing.
+class History
+{
+public:
+  void resize (std::size_t);
+  std::size_t capacity () const;
+  void add (const std::string&, bool);
+  std::size_t size () const;
+  const std::string* hidden (std::size_t) const;
+  void clear ();
+
+private:
+  std::vector <std::string> _lines  {};
+  std::vector <char>        _hidden {};
+  std::size_t               _next   {0};  // Slot of the next line
+  std::size_t               _size   {0};  // Lines held
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,272 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Index.h>
+#include <Layers.h>
+#include <LineBuffer.h>
+#include <Text.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char*       MAGIC      = "CLOGIDX2";
+static const std::size_t BLOCK_SIZE = 1 << 16;
+
+////////////////////////////////////////////////////////////////////////////////
+// The index stores native integers, being a cache for this host only.
+static void put (std::string& out, unsigned long long value)
+{
+  out.append ((const char*) &value, sizeof (value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool get (const std::string& in, std::size_t& at, unsigned long long& value)
+{
+  if (in.length () - at < sizeof (value))
+    return false;
+
+  memcpy (&value, in.data () + at, sizeof (value));
+  at += sizeof (value);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Index::path (const std::string& file)
+{
+  return file + ".clogidx";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Applies every rule, of every section, to every line of the file, and writes
+// the index.  Returns the number of blocks.
+std::size_t Index::build (
+  const std::string& file,
+  std::vector <Rule>& rules,
+  std::string::size_type max_line,
+  bool truncate)
+{
+  int fd = ::open (file.c_str (), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    throw std::string ("Cannot open ") + file + ": " + strerror (errno);
+
+  struct stat st;
+  if (fstat (fd, &st) == -1 || ! S_ISREG (st.st_mode))
+  {
+    close (fd);
+    throw std::string ("Cannot index ") + file + ", which is not a regular file.";
+  }
+
+  auto size = (std::size_t) st.st_size;
+  const char* data = nullptr;
+  if (size)
+  {
+    auto mapped = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+      close (fd);
+      throw std::string ("Cannot map ") + file + ": " + strerror (errno);
+    }
+
+    data = (const char*) mapped;
+    madvise (mapped, size, MADV_SEQUENTIAL);
+  }
+
+  close (fd);
+
+  if (size >= 2 &&
+      (((unsigned char) data[0] == 0x1f && (unsigned char) data[1] == 0x8b) ||
+       (size >= 4 && ! memcmp (data, "\x28\xb5\x2f\xfd", 4))))
+  {
+    munmap ((void*) data, size);
+    throw std::string ("Cannot index ") + file + ", which is compressed.";
+  }
+
+  auto blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  auto stride = (rules.size () + 7) / 8;
+  std::vector <unsigned long long> offsets (blocks + 1, size);
+  std::vector <unsigned char> bits (blocks * stride, 0);
+
+  Layers layers;
+  Rule::Scratch scratch;
+  std::string line;
+  LineBuffer lines;
+  lines.limit (max_line, truncate);
+  std::size_t assigned = 0;
+  std::size_t start = 0;
+  while (start < size)
+  {
+    auto eol = (const char*) memchr (data + start, '\n', size - start);
+    auto end = eol ? eol - data : size;
+
+    // Each block up to this line start begins with this line.
+    while (assigned < blocks && assigned * BLOCK_SIZE <= start)
+      offsets[assigned++] = start;
+
+    // A long line is split or truncated by the same code as when it is read,
+    // so that rules see exactly its first segment.
+    lines.clear ();
+    lines.append (data + start, end - start);
+    if (! lines.next (line))
+      lines.finish (line);
+
+    auto block = &bits[(start / BLOCK_SIZE) * stride];
+    for (std::size_t r = 0; r < rules.size (); ++r)
+    {
+      bool blanks = false;
+      layers.clear ();
+      if (rules[r].apply (scratch, layers, blanks, line))
+        block[r / 8] |= 1 << (r % 8);
+    }
+
+    start = end + 1;
+  }
+
+  if (data)
+    munmap ((void*) data, size);
+
+  std::string out (MAGIC);
+  put (out, size);
+  put (out, st.st_mtime);
+  put (out, fingerprint (rules));
+  put (out, max_line);
+  put (out, truncate);
+  put (out, rules.size ());
+  put (out, blocks);
+  for (auto offset : offsets)
+    put (out, offset);
+
+  out.append (bits.begin (), bits.end ());
+
+  std::ofstream index (path (file), std::ios::binary | std::ios::trunc);
+  if (! index.write (out.data (), out.length ()) || ! index.flush ())
+    throw std::string ("Cannot write ") + path (file) + ".";
+
+  return blocks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loads the index of a file, if there is one, and it is still valid.
+bool Index::load (
+  const std::string& file,
+  std::vector <Rule>& rules,
+  std::string::size_type max_line,
+  bool truncate)
+{
+  struct stat st;
+  if (stat (file.c_str (), &st) == -1)
+    return false;
+
+  std::ifstream index (path (file), std::ios::binary);
+  if (! index.good ())
+    return false;
+
+  std::string in ((std::istreambuf_iterator <char> (index)), std::istreambuf_iterator <char> ());
+  std::size_t at = strlen (MAGIC);
+  unsigned long long size, mtime, hash, limit, cut, count, blocks;
+  if (in.compare (0, at, MAGIC)                       ||
+      ! get (in, at, size)   || size  != (unsigned long long) st.st_size  ||
+      ! get (in, at, mtime)  || mtime != (unsigned long long) st.st_mtime ||
+      ! get (in, at, hash)   || hash  != fingerprint (rules)              ||
+      ! get (in, at, limit)  || limit != max_line                         ||
+      ! get (in, at, cut)    || cut   != (unsigned long long) truncate    ||
+      ! get (in, at, count)  || count != rules.size ()                    ||
+      ! get (in, at, blocks))
+    return false;
+
+  _stride = (count + 7) / 8;
+  if ((in.length () - at) != (blocks + 1) * sizeof (unsigned long long) + blocks * _stride)
+    return false;
+
+  _offsets.resize (blocks + 1);
+  for (auto& offset : _offsets)
+    get (in, at, offset);
+
+  _bits.assign (in.begin () + at, in.end ());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The byte ranges of the blocks where any of the given rules, by index, hit,
+// with adjacent blocks merged.
+std::vector <std::pair <std::size_t, std::size_t>> Index::spans (
+  const std::vector <std::size_t>& selected) const
+{
+  std::vector <std::pair <std::size_t, std::size_t>> spans;
+  for (std::size_t block = 0; block + 1 < _offsets.size (); ++block)
+  {
+    bool hit = false;
+    for (auto r : selected)
+      if (_bits[block * _stride + r / 8] & (1 << (r % 8)))
+        hit = true;
+
+    auto begin = _offsets[block];
+    auto end   = _offsets[block + 1];
+    if (! hit || begin == end)
+      continue;
+
+    if (spans.size () && spans.back ().second == begin)
+      spans.back ().second = end;
+    else
+      spans.push_back ({begin, end});
+  }
+
+  return spans;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A hash of what decides which lines each rule hits, FNV-1a over the
+// sections, actions and patterns, so that a color change keeps the index.
+unsigned long long Index::fingerprint (std::vector <Rule>& rules)
+{
+  std::uint64_t hash = FNV_BASIS;
+  auto mix = [&hash] (const std::string& text)
+  {
+    hash = fnv1a (text, hash);
+    hash = fnv1a ("\xff", 1, hash);
+  };
+
+  for (auto& rule : rules)
+  {
+    mix (rule._section);
+    mix (Rule::name (rule._context));
+    mix (rule._fragment);
+    mix (std::to_string ((int) rule._matcher));
+    mix (rule._rx.pattern ());
+    mix (rule._pattern);
+    if (rule._list)
+      mix (std::to_string (rule._list->fingerprint ()));
+  }
+
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_INDEX
+#define INCLUDED_INDEX
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <Rule.h>
+
+// A sidecar index of rule hits, stored next to a file as <file>.clogidx.  The
+// file is divided into fixed-size blocks, and for each block the index holds
+// the offset of the first line starting in it, and a bitmap of the rules that
+// hit any of those lines.  A run that only shows the lines hit by certain
+// rules reads just the blocks where they hit.  Rules are applied to a line as
+// a run with the same --max-line and --truncate sees it, which for a long line
+// is its first segment.  The index is ignored when the size or modification
+// time of the file, the rules, or the line limit have changed.
+class Index
+{
+public:
+  static std::string path (const std::string&);
+  static std::size_t build (const std::string&, std::vector <Rule>&, std::string::size_type, bool);
+  bool load (const std::string&, std::vector <Rule>&, std::string::size_type, bool);
+  std::vector <std::pair <std::size_t, std::size_t>> spans (const std::vector <std::size_t>&) const;
+
+private:
+  static unsigned long long fingerprint (std::vector <Rule>&);
+
+private:
+  std::vector <unsigned long long> _offsets {};  // One per block, and the end
+  std::vector <unsigned char>      _bits    {};  // _stride bytes per block
+  std::size_t                      _stride  {0};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,539 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Input.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const std::size_t CHUNK_SIZE = 1 << 16;
+
+////////////////////////////////////////////////////////////////////////////////
+Input::~Input ()
+{
+  if (_thread.joinable ())
+  {
+    _ring.cancel ();
+    auto written = write (_wake[1], "", 1);
+    (void) written;
+    _thread.join ();
+  }
+
+  for (auto fd : _wake)
+    if (fd != -1)
+      close (fd);
+
+  if (_close)
+    close (_fd);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// How many bytes the reading or decompression thread may run ahead.  Must be
+// called before open.
+void Input::budget (std::size_t bytes)
+{
+  _budget = bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Input::open (const std::string& file)
+{
+  int fd = ::open (file.c_str (), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    throw std::string ("Cannot open ") + file + ": " + strerror (errno);
+
+  open (fd);
+  _close = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Input::open (int fd)
+{
+  _fd = fd;
+
+  auto format = sniff ();
+  if (format == Format::plain)
+  {
+    _lines.append (_magic.data (), _magic.length ());
+    _magic.clear ();
+
+    // Regular files can always be read at once, and may be searched.  With
+    // no budget, pipes are read directly too.
+    struct stat st;
+    if (_budget == 0 || (fstat (_fd, &st) == 0 && S_ISREG (st.st_mode)))
+      return;
+  }
+
+  if (pipe2 (_wake, O_CLOEXEC) == -1)
+    throw std::string ("Could not create pipe: ") + strerror (errno);
+
+  _ring.reserve (_budget / CHUNK_SIZE, CHUNK_SIZE);
+  if (format == Format::plain)
+    _thread = std::thread (&Input::readAhead, this);
+  else
+    _thread = std::thread (&Input::decompress, this, format);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Confines a plain file to the part that holds the time window.  The file is
+// mapped only to search it, then read from the start of the window, and to
+// its end.  Compressed input and pipes cannot be searched, and are read whole.
+void Input::seek (TimeRange& range)
+{
+  struct stat st;
+  if (_thread.joinable () || fstat (_fd, &st) == -1 || ! S_ISREG (st.st_mode) || st.st_size == 0)
+    return;
+
+  auto size = (std::size_t) st.st_size;
+  auto data = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, _fd, 0);
+  if (data == MAP_FAILED)
+    return;
+
+  madvise (data, size, MADV_RANDOM);
+  std::size_t begin, end;
+  range.locate ((const char*) data, size, begin, end);
+  munmap (data, size);
+
+  confine ({{begin, end}});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads only the given byte ranges of a plain file, which must be sorted, and
+// begin and end at line boundaries.  Confining again reads only the bytes in
+// both.  Compressed input cannot be confined.
+void Input::confine (const std::vector <std::pair <std::size_t, std::size_t>>& spans)
+{
+  if (_thread.joinable ())
+    return;
+
+  if (_confined)
+  {
+    std::vector <std::pair <std::size_t, std::size_t>> both;
+    auto a = _spans.begin ();
+    auto b = spans.begin ();
+    while (a != _spans.end () && b != spans.end ())
+    {
+      auto begin = std::max (a->first,  b->first);
+      auto end   = std::min (a->second, b->second);
+      if (begin < end)
+        both.push_back ({begin, end});
+
+      if (a->second < b->second)
+        ++a;
+      else
+        ++b;
+    }
+
+    _spans.swap (both);
+  }
+  else
+    _spans = spans;
+
+  _confined = true;
+  _next = 0;
+  _remaining = 0;
+  _magic.clear ();
+  _lines.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads the first bytes, which are retained, because stdin cannot be rewound.
+Input::Format Input::sniff ()
+{
+  char magic[4];
+  std::size_t length = 0;
+  while (length < sizeof (magic))
+  {
+    auto got = read (_fd, magic + length, sizeof (magic) - length);
+    if (got == -1 && errno == EINTR)
+      continue;
+
+    if (got <= 0)
+      break;
+
+    length += got;
+  }
+
+  _magic.assign (magic, length);
+  _arrival = std::chrono::steady_clock::now ();
+
+  if (length >= 2 &&
+      (unsigned char) magic[0] == 0x1f &&
+      (unsigned char) magic[1] == 0x8b)
+    return Format::gzip;
+
+  if (length == 4 &&
+      (unsigned char) magic[0] == 0x28 &&
+      (unsigned char) magic[1] == 0xb5 &&
+      (unsigned char) magic[2] == 0x2f &&
+      (unsigned char) magic[3] == 0xfd)
+    return Format::zstd;
+
+  return Format::plain;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Limits the line length, see LineBuffer.
+void Input::limit (std::string::size_type length, bool truncate)
+{
+  _lines.limit (length, truncate);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Like std::getline, strips the \n, and returns a final unterminated line.  A
+// line longer than the limit is returned in segments, or truncated.
+bool Input::getline (std::string& line)
+{
+  while (true)
+  {
+    if (_lines.next (line))
+      return true;
+
+    if (_eof)
+      return _lines.finish (line);
+
+    if (_drain)
+      _drain ();
+
+    _eof = ! fill ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The bytes of the last line, with its \n, in the input buffer, if it is whole
+// there, see drain.
+bool Input::raw (const char*& data, std::size_t& length) const
+{
+  return _lines.raw (data, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sets a function called before more input is read, which may wait, and which
+// moves or overwrites the bytes of the lines returned so far.  Output that
+// refers to them must be written by then.
+void Input::drain (std::function <void ()> function)
+{
+  _drain = function;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string::size_type Input::overlap () const
+{
+  return _lines.overlap ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string::size_type Input::cut () const
+{
+  return _lines.cut ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// When the bytes that completed the last line were read.  Every line taken
+// from one read arrived together.
+std::chrono::steady_clock::time_point Input::arrival () const
+{
+  return _arrival;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Bytes read ahead, and not yet consumed.
+std::size_t Input::queued () const
+{
+  return _ring.queued ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The most bytes ever read ahead.
+std::size_t Input::high () const
+{
+  return _ring.high ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends more input to the line buffer, returning false at end of input.
+bool Input::fill ()
+{
+  if (! _thread.joinable ())
+  {
+    auto got = readRaw (_lines.reserve (CHUNK_SIZE), CHUNK_SIZE);
+    _lines.commit (got);
+    _arrival = std::chrono::steady_clock::now ();
+    return got > 0;
+  }
+
+  // A chunk arrived when it was read, not when it was taken from the ring.
+  const char* data;
+  std::size_t length;
+  if (! _ring.consume (data, length, _arrival))
+    return false;
+
+  _lines.append (data, length);
+  _ring.release ();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads the next bytes of the raw stream, starting with the sniffed magic.
+std::size_t Input::readRaw (char* buffer, std::size_t size)
+{
+  if (_magic.length ())
+  {
+    auto length = std::min (size, _magic.length ());
+    memcpy (buffer, _magic.data (), length);
+    _magic.erase (0, length);
+    return length;
+  }
+
+  while (_confined && _remaining == 0 && _next < _spans.size ())
+  {
+    if (lseek (_fd, _spans[_next].first, SEEK_SET) == -1)
+      throw std::string ("Seek error: ") + strerror (errno);
+
+    _remaining = _spans[_next].second - _spans[_next].first;
+    ++_next;
+  }
+
+  size = std::min (size, _remaining);
+  while (size)
+  {
+    // A thread waits for input alongside the pipe that wakes it to go away.
+    if (_wake[0] != -1)
+    {
+      struct pollfd fds[2] {{_fd, POLLIN, 0}, {_wake[0], POLLIN, 0}};
+      if (poll (fds, 2, -1) == -1)
+      {
+        if (errno == EINTR)
+          continue;
+
+        throw std::string ("Poll error: ") + strerror (errno);
+      }
+
+      if (fds[1].revents)
+        return 0;
+    }
+
+    auto got = read (_fd, buffer, size);
+    if (got >= 0)
+    {
+      _remaining -= got;
+      return got;
+    }
+
+    if (errno != EINTR)
+      throw std::string ("Read error: ") + strerror (errno);
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reading thread, for pipes.  Reads as soon as input is available, so that the
+// writer upstream is not held up by a slow output, until the budget is used.
+void Input::readAhead ()
+{
+  std::string error;
+  try
+  {
+    while (auto chunk = _ring.produce ())
+    {
+      auto got = readRaw (chunk, CHUNK_SIZE);
+      if (got == 0)
+        break;
+
+      _ring.publish (got);
+    }
+  }
+
+  catch (const std::string& e)
+  {
+    error = e;
+  }
+
+  _ring.finish (error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decompression thread.  Errors are passed to the reader, which reports them
+// once it has consumed everything decompressed before the error.
+void Input::decompress (Format format)
+{
+  std::string error;
+  try
+  {
+    if (format == Format::gzip)
+      gunzip ();
+    else
+      unzstd ();
+  }
+
+  catch (const std::string& e)
+  {
+    error = e;
+  }
+
+  _ring.finish (error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Handles concatenated gzip members, as produced by 'cat a.gz b.gz', and zero
+// padding after the last of them, as written to tapes and block devices.
+void Input::gunzip ()
+{
+#ifdef HAVE_ZLIB
+  z_stream stream;
+  memset (&stream, 0, sizeof (stream));
+  if (inflateInit2 (&stream, 15 + 16) != Z_OK)
+    throw std::string ("Could not initialize zlib.");
+
+  std::string compressed (CHUNK_SIZE, '\0');
+  bool end_of_input = false;
+  bool member_ended = false;
+  bool padded = false;
+  while (true)
+  {
+    if (stream.avail_in == 0 && ! end_of_input)
+    {
+      stream.next_in = (Bytef*) &compressed[0];
+      stream.avail_in = readRaw (&compressed[0], CHUNK_SIZE);
+      end_of_input = stream.avail_in == 0;
+    }
+
+    // A member starts with 0x1f, so a zero byte after one begins padding,
+    // which must run to the end of the input.
+    if (member_ended && stream.avail_in && (padded || stream.next_in[0] == 0))
+    {
+      auto end = stream.next_in + stream.avail_in;
+      if (std::find_if (stream.next_in, end, [] (Bytef byte) { return byte != 0; }) != end)
+      {
+        inflateEnd (&stream);
+        throw std::string ("Corrupt gzip input.");
+      }
+
+      stream.avail_in = 0;
+      padded = true;
+      continue;
+    }
+
+    if (end_of_input && stream.avail_in == 0 && member_ended)
+      break;
+
+    auto chunk = _ring.produce ();
+    if (! chunk)
+      break;
+
+    stream.next_out = (Bytef*) chunk;
+    stream.avail_out = CHUNK_SIZE;
+    auto status = inflate (&stream, Z_NO_FLUSH);
+    _ring.publish (CHUNK_SIZE - stream.avail_out);
+
+    if (status == Z_STREAM_END)
+    {
+      member_ended = true;
+      inflateReset (&stream);
+    }
+    else if (status == Z_OK)
+      member_ended = false;
+    else if (status != Z_BUF_ERROR || end_of_input)
+    {
+      inflateEnd (&stream);
+      throw std::string (status == Z_BUF_ERROR ? "Truncated gzip input." : "Corrupt gzip input.");
+    }
+  }
+
+  inflateEnd (&stream);
+#else
+  throw std::string ("Input is gzip compressed, but clog was built without zlib.");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Input::unzstd ()
+{
+#ifdef HAVE_ZSTD
+  auto stream = ZSTD_createDStream ();
+  if (! stream)
+    throw std::string ("Could not initialize zstd.");
+
+  ZSTD_initDStream (stream);
+
+  std::string compressed (ZSTD_DStreamInSize (), '\0');
+  ZSTD_inBuffer in {compressed.data (), 0, 0};
+  bool end_of_input = false;
+  bool pending = false;
+  size_t hint = 0;
+  while (true)
+  {
+    if (in.pos == in.size && ! end_of_input)
+    {
+      in.size = readRaw (&compressed[0], compressed.length ());
+      in.pos = 0;
+      end_of_input = in.size == 0;
+    }
+
+    // The decoder may hold output back when the previous chunk was filled.
+    if (end_of_input && in.pos == in.size && ! pending)
+      break;
+
+    auto chunk = _ring.produce ();
+    if (! chunk)
+      break;
+
+    ZSTD_outBuffer out {chunk, CHUNK_SIZE, 0};
+    hint = ZSTD_decompressStream (stream, &out, &in);
+    _ring.publish (out.pos);
+
+    if (ZSTD_isError (hint))
+    {
+      ZSTD_freeDStream (stream);
+      throw std::string ("Corrupt zstd input: ") + ZSTD_getErrorName (hint);
+    }
+
+    pending = out.pos == out.size;
+  }
+
+  ZSTD_freeDStream (stream);
+  if (hint != 0)
+    throw std::string ("Truncated zstd input.");
+#else
+  throw std::string ("Input is zstd compressed, but clog was built without zstd.");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
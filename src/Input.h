@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_INPUT
+#define INCLUDED_INPUT
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <LineBuffer.h>
+#include <Ring.h>
+#include <TimeRange.h>
+
+// Reads lines from a file descriptor.  Compressed input is recognized by its
+// magic bytes, and is decompressed on a separate thread, so that decompression
+// overlaps rule evaluation.  Pipes are read on a separate thread too, ahead of
+// the consumer by up to the budget, so that a stalled output does not block
+// the writer upstream.  Plain files are read directly.
+class Input
+{
+public:
+  Input () = default;
+  Input (const Input&) = delete;
+  Input& operator= (const Input&) = delete;
+  ~Input ();
+
+  void budget (std::size_t);
+  void open (const std::string&);
+  void open (int);
+  void seek (TimeRange&);
+  void confine (const std::vector <std::pair <std::size_t, std::size_t>>&);
+  void limit (std::string::size_type, bool);
+  bool getline (std::string&);
+  bool raw (const char*&, std::size_t&) const;
+  void drain (std::function <void ()>);
+  std::string::size_type overlap () const;
+  std::string::size_type cut () const;
+  std::chrono::steady_clock::time_point arrival () const;
+  std::size_t queued () const;
+  std::size_t high () const;
+
+private:
+  enum class Format { plain, gzip, zstd };
+
+  Format sniff ();
+  bool fill ();
+  void readAhead ();
+  void decompress (Format);
+  void gunzip ();
+  void unzstd ();
+  std::size_t readRaw (char*, std::size_t);
+
+private:
+  int                     _fd        {-1};
+  bool                    _close     {false};
+  bool                    _eof       {false};
+  LineBuffer              _lines     {};
+  std::string             _magic     {};
+  std::chrono::steady_clock::time_point _arrival {};
+  std::function <void ()> _drain    {};
+
+  // Byte ranges of a plain file still to be read, if confined.
+  bool                    _confined  {false};
+  std::vector <std::pair <std::size_t, std::size_t>> _spans {};
+  std::size_t             _next      {0};
+  std::size_t             _remaining {std::string::npos};
+
+  // Chunks passed from the reading or decompression thread, which is woken
+  // through the pipe when the reader goes away.
+  std::size_t             _budget    {16 << 20};
+  std::thread             _thread    {};
+  Ring                    _ring      {};
+  int                     _wake[2]   {-1, -1};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Layers.h>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+void Layers::add (
+  std::string::size_type offset,
+  std::string::size_type length,
+  const Color& color)
+{
+  _layers.push_back ({_origin + offset, length, paint (color)});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Where offsets given to add count from, for a rule that matches part of the
+// line as a line of its own.
+void Layers::origin (std::string::size_type offset)
+{
+  _origin = offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Layers::clear ()
+{
+  _layers.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The rendered width, which is zero once a line is suppressed.
+std::string::size_type Layers::width () const
+{
+  std::string::size_type width = 0;
+  for (auto& layer : _layers)
+    width = std::max (width, layer._offset + layer._length);
+
+  return width;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// True if a line of the given length would render as it is, because a single
+// uncolored layer covers all of it.
+bool Layers::bare (std::string::size_type length) const
+{
+  return _layers.size () == 1             &&
+         _layers[0]._offset == 0          &&
+         _layers[0]._length == length     &&
+         _paints[_layers[0]._paint]._on == "" &&
+         _paints[_layers[0]._paint]._off == "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends the colorized line, between the given offsets, to output.  Each byte
+// takes the color of the topmost layer covering it, and bytes covered by no
+// layer become blanks.
+void Layers::render (
+  const std::string& line,
+  std::string& output,
+  std::string::size_type from,
+  std::string::size_type to)
+{
+  _cells.assign (width (), -1);
+  auto total = std::min (width (), to);
+
+  for (auto& layer : _layers)
+    std::fill (_cells.begin () + layer._offset,
+               _cells.begin () + layer._offset + layer._length,
+               layer._paint);
+
+  std::string::size_type start = from;
+  while (start < total)
+  {
+    auto cell = _cells[start];
+    auto end = start + 1;
+    while (end < total && _cells[end] == cell)
+      ++end;
+
+    if (cell == -1)
+      output.append (end - start, ' ');
+    else
+    {
+      auto& paint = _paints[cell];
+      output += paint._on;
+      output.append (line, start, std::min (end, line.length ()) - std::min (start, line.length ()));
+      output += paint._off;
+    }
+
+    start = end;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends the same part of the line as render, without colors.
+void Layers::plain (
+  const std::string& line,
+  std::string& output,
+  std::string::size_type from,
+  std::string::size_type to) const
+{
+  auto total = std::min (std::min (width (), to), line.length ());
+  if (from < total)
+    output.append (line, from, total - from);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the index of the paint for the color, creating it on first use.  The
+// escape sequences are those that Color::colorize wraps around text.
+int Layers::paint (const Color& color)
+{
+  for (unsigned int i = 0; i < _paints.size (); ++i)
+    if (_paints[i]._color == color)
+      return i;
+
+  Paint paint {color, "", ""};
+  if (color.nontrivial ())
+  {
+    auto sample = color.colorize ("\x01");
+    auto marker = sample.find ('\x01');
+    paint._on  = sample.substr (0, marker);
+    paint._off = sample.substr (marker + 1);
+  }
+
+  _paints.push_back (paint);
+  return _paints.size () - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_LAYERS
+#define INCLUDED_LAYERS
+
+#include <string>
+#include <vector>
+#include <Color.h>
+
+// Layers of color applied to ranges of one line, later rules on top of earlier
+// ones.  Unlike Composite, a layer refers to the line by offset rather than
+// holding a copy of the text, and all storage is retained across lines, so
+// that in steady state, rendering a line allocates nothing.
+class Layers
+{
+public:
+  void add (std::string::size_type, std::string::size_type, const Color&);
+  void origin (std::string::size_type);
+  void clear ();
+  std::string::size_type width () const;
+  bool bare (std::string::size_type) const;
+  void render (const std::string&, std::string&, std::string::size_type = 0, std::string::size_type = std::string::npos);
+  void plain (const std::string&, std::string&, std::string::size_type = 0, std::string::size_type = std::string::npos) const;
+
+private:
+  int paint (const Color&);
+
+private:
+  struct Layer
+  {
+    std::string::size_type _offset;
+    std::string::size_type _length;
+    int                    _paint;
+  };
+
+  // Each distinct color is converted to escape sequences only once.
+  struct Paint
+  {
+    Color       _color;
+    std::string _on;
+    std::string _off;
+  };
+
+  std::vector <Layer>    _layers {};
+  std::vector <Paint>    _paints {};
+  std::vector <int>      _cells  {};
+  std::string::size_type _origin {0};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
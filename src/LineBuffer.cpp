@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <LineBuffer.h>
+#include <algorithm>
+#include <cstring>
+
+// Lines are limited to 1MiB unless configured otherwise, and split segments
+// repeat this much of the previous segment.
+static const std::string::size_type DEFAULT_LIMIT = 1 << 20;
+static const std::string::size_type OVERLAP       = 1 << 10;
+
+////////////////////////////////////////////////////////////////////////////////
+LineBuffer::LineBuffer ()
+{
+  limit (DEFAULT_LIMIT, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A limit of zero means lines are unbounded.
+void LineBuffer::limit (std::string::size_type length, bool truncate)
+{
+  _limit = length ? length : std::string::npos;
+  _truncate = truncate;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns space for at least size more bytes, which the caller fills, then
+// commits.  Consumed lines are discarded first, so the buffer never holds more
+// than one partial line before the new bytes.
+char* LineBuffer::reserve (std::string::size_type size)
+{
+  if (_cursor)
+  {
+    _buffer.erase (0, _cursor);
+    _scanned -= _cursor;
+    _cursor = 0;
+  }
+
+  auto length = _buffer.length ();
+  _buffer.resize (length + size);
+  _reserved = size;
+  return &_buffer[length];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Trims the reserved space to the bytes actually filled.
+void LineBuffer::commit (std::string::size_type size)
+{
+  _buffer.resize (_buffer.length () - _reserved + size);
+  _reserved = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LineBuffer::append (const char* data, std::string::size_type size)
+{
+  memcpy (reserve (size), data, size);
+  commit (size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Discards everything buffered, keeping the limit.
+void LineBuffer::clear ()
+{
+  _buffer.clear ();
+  _cursor = _scanned = _reserved = 0;
+  _carry.clear ();
+  _overlap = 0;
+  _cut = 0;
+  _continued = false;
+  _discarding = false;
+  _dropped = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Gets the next complete line, without its \n, or a segment of a long line.
+// Each byte is scanned for \n only once, however the line arrives.
+bool LineBuffer::next (std::string& line)
+{
+  _raw = nullptr;
+  while (true)
+  {
+    auto available = _buffer.length () - _cursor;
+    // A line of exactly the limit is whole, so its \n is looked for too.
+    auto scan_end = _cursor + (_discarding || available <= _limit ? available : _limit + 1);
+    auto eol = (const char*) memchr (_buffer.data () + _scanned, '\n', scan_end - _scanned);
+
+    if (_discarding)
+    {
+      if (! eol)
+      {
+        // Nothing of the remainder is kept.
+        _dropped += available;
+        _cursor = _scanned = _buffer.length ();
+        return false;
+      }
+
+      _dropped += eol - _buffer.data () - _cursor;
+      _cursor = _scanned = eol - _buffer.data () + 1;
+      truncated (line);
+      return true;
+    }
+
+    if (eol)
+    {
+      auto end = eol - _buffer.data ();
+      if (_carry.empty ())
+      {
+        _raw = _buffer.data () + _cursor;
+        _rawLength = end + 1 - _cursor;
+      }
+
+      line.assign (_carry);
+      line.append (_buffer, _cursor, end - _cursor);
+      _overlap = _carry.length () - _carry.length () / 2;
+      _continued = false;
+      _carry.clear ();
+      _cursor = _scanned = end + 1;
+      return true;
+    }
+
+    _scanned = scan_end;
+    if (available <= _limit)
+      return false;
+
+    // The line is too long.
+    if (_truncate)
+    {
+      _carry.assign (_buffer, _cursor, _limit);
+      _cursor = _scanned = _cursor + _limit;
+      _dropped = 0;
+      _discarding = true;
+      continue;
+    }
+
+    // The repeated tail is output half with this segment and half with the
+    // next, so a short match across the boundary is whole in both.
+    line.assign (_carry);
+    line.append (_buffer, _cursor, _limit);
+    _overlap = _carry.length () - _carry.length () / 2;
+    _continued = true;
+    _cursor = _scanned = _cursor + _limit;
+
+    auto keep = std::min (OVERLAP, line.length ());
+    _cut = line.length () - keep / 2;
+    _carry.assign (line, line.length () - keep, keep);
+    return true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// At end of input, gets the final unterminated line, if there is one.
+bool LineBuffer::finish (std::string& line)
+{
+  _raw = nullptr;
+  if (_discarding)
+  {
+    _dropped += _buffer.length () - _cursor;
+    _cursor = _scanned = _buffer.length ();
+    truncated (line);
+    return true;
+  }
+
+  if (_cursor < _buffer.length () || _continued)
+  {
+    line.assign (_carry);
+    line.append (_buffer, _cursor, std::string::npos);
+    _overlap = _carry.length () - _carry.length () / 2;
+    _continued = false;
+    _carry.clear ();
+    _cursor = _scanned = _buffer.length ();
+    return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The bytes of the line last returned, with its \n, if it was whole in the
+// buffer.  They stay valid until more input is added.
+bool LineBuffer::raw (const char*& data, std::string::size_type& length) const
+{
+  data = _raw;
+  length = _rawLength;
+  return _raw != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The kept part of a truncated line, and a marker saying how much is missing.
+void LineBuffer::truncated (std::string& line)
+{
+  line.assign (_carry);
+  line += " [";
+  line += std::to_string (_dropped);
+  line += " bytes truncated]";
+
+  _overlap = 0;
+  _continued = false;
+  _discarding = false;
+  _carry.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The number of leading bytes of the last line that repeat the end of the
+// previous segment, and were already output.
+std::string::size_type LineBuffer::overlap () const
+{
+  return _overlap;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// If the last line was a segment, and the line continues, the offset where its
+// output stops, the rest being output with the next segment.  Otherwise npos.
+std::string::size_type LineBuffer::cut () const
+{
+  return _continued ? _cut : std::string::npos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_LINEBUFFER
+#define INCLUDED_LINEBUFFER
+
+#include <string>
+
+// Splits a stream of bytes into lines, holding at most one maximum length line
+// plus whatever was appended since.  A longer line is either split into
+// segments, each of which begins with the tail of the previous segment, so that
+// patterns spanning the boundary still match, or truncated with a marker.
+class LineBuffer
+{
+public:
+  LineBuffer ();
+  void limit (std::string::size_type, bool);
+  char* reserve (std::string::size_type);
+  void commit (std::string::size_type);
+  void append (const char*, std::string::size_type);
+  void clear ();
+  bool next (std::string&);
+  bool finish (std::string&);
+  bool raw (const char*&, std::string::size_type&) const;
+  std::string::size_type overlap () const;
+  std::string::size_type cut () const;
+
+private:
+  void truncated (std::string&);
+
+private:
+  std::string            _buffer     {};
+  std::string::size_type _cursor     {0};
+  std::string::size_type _scanned    {0};
+  std::string::size_type _reserved   {0};
+  std::string::size_type _limit      {0};
+  bool                   _truncate   {false};
+  std::string            _carry      {};
+  std::string::size_type _overlap    {0};
+  std::string::size_type _cut        {0};
+  bool                   _continued  {false};
+  bool                   _discarding {false};
+  std::string::size_type _dropped    {0};
+  const char*            _raw        {nullptr};
+  std::string::size_type _rawLength  {0};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,808 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Pager.h>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+#include <shared.h>
+
+static const std::size_t INTERVAL   = 256;      // Lines per index entry
+static const std::size_t CACHE_SIZE = 512;      // Rendered lines kept
+static const std::size_t MAX_LINE   = 1 << 20;  // Bytes of a line the rules see
+static const std::size_t CHECK_RATE = 16384;    // Lines searched between checks
+                                                // for a key, which cancels
+
+static volatile sig_atomic_t resized = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+static void onResize (int)
+{
+  resized = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void writeAll (int fd, const std::string& text)
+{
+  std::size_t written = 0;
+  while (written < text.length ())
+  {
+    auto result = write (fd, text.data () + written, text.length () - written);
+    if (result == -1 && errno == EINTR)
+      continue;
+
+    if (result <= 0)
+      break;
+
+    written += result;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends a rendered row, cut to width columns.  Color escapes take no room,
+// tabs extend to the next multiple of eight columns, UTF-8 continuation bytes
+// share the column of their lead byte, and control characters show as '?'.
+static void clip (
+  const std::string& text,
+  std::string::size_type begin,
+  std::string::size_type end,
+  std::size_t width,
+  std::string& output)
+{
+  std::size_t column = 0;
+  for (auto i = begin; i < end; ++i)
+  {
+    auto c = (unsigned char) text[i];
+    if (c == 0x1b)
+    {
+      auto stop = text.find ('m', i);
+      if (stop == std::string::npos || stop >= end)
+        break;
+
+      output.append (text, i, stop - i + 1);
+      i = stop;
+    }
+    else if ((c & 0xc0) == 0x80)
+      output += text[i];
+
+    else if (column >= width)
+      break;
+
+    else if (c == '\t')
+    {
+      auto spaces = std::min (8 - column % 8, width - column);
+      output.append (spaces, ' ');
+      column += spaces;
+    }
+    else
+    {
+      output += c < 0x20 || c == 0x7f ? '?' : text[i];
+      ++column;
+    }
+  }
+
+  output += "\x1b[0m\x1b[K";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Puts the terminal in raw mode, and shows the alternate screen without the
+// cursor, until destroyed.
+struct Terminal
+{
+  explicit Terminal (int fd)
+  : _fd (fd)
+  {
+    if (tcgetattr (_fd, &_saved) == -1)
+      throw std::string ("Cannot configure the terminal: ") + strerror (errno);
+
+    auto raw = _saved;
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+    raw.c_iflag &= ~(IXON | ICRNL);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr (_fd, TCSAFLUSH, &raw);
+    writeAll (STDOUT_FILENO, "\x1b[?1049h\x1b[?25l");
+  }
+
+  ~Terminal ()
+  {
+    writeAll (STDOUT_FILENO, "\x1b[?25h\x1b[?1049l");
+    tcsetattr (_fd, TCSAFLUSH, &_saved);
+  }
+
+  int            _fd;
+  struct termios _saved;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Context is a matter of a stream of lines, which the pager does not have, so
+// it is turned off.
+Pager::Pager (
+  std::vector <Rule>& rules,
+  const std::vector <std::string>& sections)
+: _rules (rules)
+, _filter (rules, sections)
+, _cache (CACHE_SIZE, {std::string::npos, ""})
+{
+  _filter.context (0, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pager::~Pager ()
+{
+  _stop = true;
+  if (_thread.joinable ())
+    _thread.join ();
+
+  if (_data)
+    munmap ((void*) _data, _size);
+
+  if (_tty != -1)
+    close (_tty);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Maps the file, and starts indexing it.
+void Pager::open (const std::string& file)
+{
+  int fd = ::open (file.c_str (), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    throw std::string ("Cannot open ") + file + ": " + strerror (errno);
+
+  struct stat st;
+  if (fstat (fd, &st) == -1 || ! S_ISREG (st.st_mode))
+  {
+    close (fd);
+    throw std::string ("Cannot page ") + file + ", which is not a regular file.";
+  }
+
+  _size = (std::size_t) st.st_size;
+  if (_size)
+  {
+    auto mapped = mmap (nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+      close (fd);
+      throw std::string ("Cannot map ") + file + ": " + strerror (errno);
+    }
+
+    _data = (const char*) mapped;
+  }
+
+  close (fd);
+
+  if (_size >= 2 &&
+      (((unsigned char) _data[0] == 0x1f && (unsigned char) _data[1] == 0x8b) ||
+       (_size >= 4 && ! memcmp (_data, "\x28\xb5\x2f\xfd", 4))))
+    throw std::string ("Cannot page ") + file + ", which is compressed.";
+
+  _file = file;
+  _thread = std::thread (&Pager::index, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Records the start of every INTERVAL-th line, publishing them in batches.
+void Pager::index ()
+{
+  std::vector <std::size_t> starts;
+  std::size_t lines = 0;
+  std::size_t pos = 0;
+  while (pos < _size && ! _stop)
+  {
+    if (lines % INTERVAL == 0)
+      starts.push_back (pos);
+
+    auto eol = (const char*) memchr (_data + pos, '\n', _size - pos);
+    pos = eol ? eol - _data + 1 : _size;
+    ++lines;
+
+    if (starts.size () == 1024 || pos == _size)
+    {
+      std::lock_guard <std::mutex> lock (_mutex);
+      _starts.insert (_starts.end (), starts.begin (), starts.end ());
+      _lines = lines;
+      _scanned = pos;
+      starts.clear ();
+    }
+  }
+
+  _indexed = pos == _size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t Pager::size () const
+{
+  return _size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The start of the line after the one at offset, or the size at the end.
+std::size_t Pager::next (std::size_t offset) const
+{
+  if (offset >= _size)
+    return _size;
+
+  auto eol = (const char*) memchr (_data + offset, '\n', _size - offset);
+  return eol ? eol - _data + 1 : _size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The start of the line before the one at offset, which may be the size.
+std::size_t Pager::previous (std::size_t offset) const
+{
+  if (offset <= 1)
+    return 0;
+
+  auto pos = offset - 1;
+  while (pos > 0 && _data[pos - 1] != '\n')
+    --pos;
+
+  return pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The line at offset, without its \n, and cut short for the rules.
+void Pager::line (std::size_t offset, std::string& text) const
+{
+  auto end = next (offset);
+  if (end > offset && _data[end - 1] == '\n')
+    --end;
+
+  text.assign (_data + offset, std::min (end - offset, MAX_LINE));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The line at offset with the rules applied, as it would be output, which is
+// nothing if it is suppressed.
+const std::string& Pager::render (std::size_t offset)
+{
+  auto& slot = _cache[(offset * 0x9e3779b97f4a7c15ULL >> 40) % CACHE_SIZE];
+  if (slot._offset != offset)
+  {
+    line (offset, _line);
+    slot._output.clear ();
+    _filter.apply (_line, slot._output);
+    slot._offset = offset;
+  }
+
+  return slot._output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Screen rows of the line at offset, which blank rules add to.
+std::size_t Pager::rows (std::size_t offset)
+{
+  auto& output = render (offset);
+  return std::count (output.begin (), output.end (), '\n');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The number of the line at offset, counting from 1, unless it is not indexed
+// yet.  Lines are counted from the nearest index entry.
+bool Pager::number (std::size_t offset, std::size_t& number)
+{
+  std::size_t start;
+  std::size_t entry;
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    auto it = std::upper_bound (_starts.begin (), _starts.end (), offset);
+    if (it == _starts.begin () || (! _indexed && offset >= _scanned))
+      return false;
+
+    start = *--it;
+    entry = it - _starts.begin ();
+  }
+
+  number = entry * INTERVAL + 1;
+  for (auto pos = start; (pos = next (pos)) <= offset && pos < _size; )
+    ++number;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The offset of a line by number, or of the last line.  Lines beyond the index
+// are counted from its end.
+std::size_t Pager::seek (std::size_t number)
+{
+  std::size_t pos = 0;
+  std::size_t line = 0;
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    if (_starts.size () && number > 0)
+    {
+      auto entry = std::min ((number - 1) / INTERVAL, _starts.size () - 1);
+      pos = _starts[entry];
+      line = entry * INTERVAL;
+    }
+  }
+
+  while (line + 1 < number && next (pos) < _size)
+  {
+    pos = next (pos);
+    ++line;
+  }
+
+  return pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether indexing is complete, and the lines indexed so far.
+bool Pager::indexed (std::size_t& lines) const
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  lines = _lines;
+  return _indexed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Waits for indexing to complete.
+void Pager::wait ()
+{
+  if (_thread.joinable ())
+    _thread.join ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The rules, by index, that n and N search for.
+void Pager::search (const std::vector <std::size_t>& indexes)
+{
+  _search = indexes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The offset of the next line, after or before the one at from, that a rule
+// searched for hits, or npos.  A key pressed meanwhile cancels the search.
+std::size_t Pager::find (std::size_t from, bool forward)
+{
+  auto pos = from;
+  for (std::size_t checked = 1; ; ++checked)
+  {
+    if (forward)
+    {
+      pos = next (pos);
+      if (pos >= _size)
+        return std::string::npos;
+    }
+    else
+    {
+      if (pos == 0)
+        return std::string::npos;
+
+      pos = previous (pos);
+    }
+
+    line (pos, _line);
+    for (auto index : _search)
+      if (_rules[index].hits (_scratch, _line))
+        return pos;
+
+    if (checked % CHECK_RATE == 0 && cancelled ())
+      return std::string::npos;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Pager::cancelled ()
+{
+  if (_tty == -1)
+    return false;
+
+  struct pollfd fd {_tty, POLLIN, 0};
+  if (poll (&fd, 1, 0) <= 0)
+    return false;
+
+  char buffer[64];
+  auto got = read (_tty, buffer, sizeof (buffer));
+  (void) got;
+  _message = "Search cancelled.";
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Pager::top (std::size_t offset, std::size_t row)
+{
+  _top = offset;
+  _row = row;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t Pager::top () const
+{
+  return _top;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scrolls forward by rows, skipping suppressed lines, until the end of the
+// file is shown.
+void Pager::down (std::size_t count)
+{
+  while (count-- && ! atEnd ())
+  {
+    if (_row + 1 < rows (_top))
+    {
+      ++_row;
+      continue;
+    }
+
+    auto pos = next (_top);
+    while (pos < _size && rows (pos) == 0)
+      pos = next (pos);
+
+    if (pos >= _size)
+      break;
+
+    top (pos, 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scrolls back by rows, skipping suppressed lines.
+void Pager::up (std::size_t count)
+{
+  while (count--)
+  {
+    if (_row > 0)
+    {
+      --_row;
+      continue;
+    }
+
+    auto pos = _top;
+    std::size_t found = 0;
+    while (pos > 0 && found == 0)
+    {
+      pos = previous (pos);
+      found = rows (pos);
+    }
+
+    if (found == 0)
+      break;
+
+    top (pos, found - 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Shows the last screen of the file, found from its end, without the index.
+void Pager::end ()
+{
+  top (_size, 0);
+  up (_height);
+  if (_top == _size)
+    top (0, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether the rest of the file, from the top, fits on the screen.
+bool Pager::atEnd ()
+{
+  std::size_t shown = 0;
+  auto skip = _row;
+  for (auto pos = _top; pos < _size; pos = next (pos))
+  {
+    auto count = rows (pos);
+    shown += count > skip ? count - skip : 0;
+    if (shown > _height)
+      return false;
+
+    skip = 0;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Pager::height (std::size_t rows)
+{
+  _height = rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Shows the file until q is pressed.  Keys are read from the terminal, and
+// the screen is redrawn after each batch of them, or while indexing, as it
+// progresses.
+int Pager::run ()
+{
+  _tty = ::open ("/dev/tty", O_RDWR | O_CLOEXEC);
+  if (_tty == -1)
+    throw std::string ("Cannot open the terminal: ") + strerror (errno);
+
+  Terminal terminal (_tty);
+
+  struct sigaction action {};
+  action.sa_handler = onResize;
+  sigaction (SIGWINCH, &action, nullptr);
+
+  std::size_t count = 0;
+  while (true)
+  {
+    if (resized)
+    {
+      resized = 0;
+      struct winsize size;
+      if (ioctl (STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 1)
+      {
+        height (size.ws_row - 1);
+        _width = size.ws_col;
+      }
+    }
+
+    draw ();
+
+    struct pollfd fd {_tty, POLLIN, 0};
+    auto ready = poll (&fd, 1, _indexed ? -1 : 250);
+    if (ready == -1 && errno != EINTR)
+      throw std::string ("Poll error: ") + strerror (errno);
+
+    if (ready <= 0)
+      continue;
+
+    std::string pressed;
+    do
+    {
+      if (! keystroke (pressed) || ! key (pressed, count))
+        return 0;
+    }
+    while (_input.length ());
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The next key, from those read in one batch, where an escape sequence is one
+// key.  Waits for one if there are none.
+bool Pager::keystroke (std::string& pressed)
+{
+  if (_input.length () == 0)
+  {
+    char buffer[64];
+    auto got = read (_tty, buffer, sizeof (buffer));
+    if (got <= 0)
+      return false;
+
+    _input.assign (buffer, got);
+  }
+
+  std::string::size_type length = 1;
+  if (_input[0] == '\x1b' && _input.length () > 1 && _input[1] == '[')
+  {
+    length = 2;
+    while (length < _input.length () && (_input[length] < 0x40 || _input[length] > 0x7e))
+      ++length;
+
+    if (length < _input.length ())
+      ++length;
+  }
+
+  pressed = _input.substr (0, length);
+  _input.erase (0, length);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Acts on one key, with any count typed before it.  Returns false to quit.
+bool Pager::key (const std::string& key, std::size_t& count)
+{
+  _message = "";
+
+  if (key.length () == 1 && key[0] >= '0' && key[0] <= '9')
+  {
+    count = count * 10 + (key[0] - '0');
+    return true;
+  }
+
+  auto times = std::max (count, (std::size_t) 1);
+  auto number = count;
+  count = 0;
+
+  if (key == "q" || key == "Q" || key == "\x03")
+    return false;
+
+  else if (key == "j" || key == "e" || key == "\r" || key == "\n" || key == "\x1b[B")
+    down (times);
+
+  else if (key == "k" || key == "y" || key == "\x1b[A")
+    up (times);
+
+  else if (key == " " || key == "f" || key == "\x1b[6~")
+    down (_height * times);
+
+  else if (key == "b" || key == "\x1b[5~")
+    up (_height * times);
+
+  else if (key == "d")
+    down (_height / 2 * times);
+
+  else if (key == "u")
+    up (_height / 2 * times);
+
+  else if (key == "g" || key == "<" || key == "\x1b[H" || key == "\x1b[1~")
+    top (number ? seek (number) : 0, 0);
+
+  else if (key == "G" || key == ">" || key == "\x1b[F" || key == "\x1b[4~")
+  {
+    if (number)
+      top (seek (number), 0);
+    else
+      end ();
+  }
+
+  else if (key == "/")
+  {
+    std::string answer;
+    if (prompt ("Search for rules: ", answer))
+    {
+      std::vector <std::size_t> indexes;
+      for (auto& word : split (answer, ','))
+      {
+        char* end;
+        auto value = strtoul (word.c_str (), &end, 10);
+        if (word == "" || *end || value < 1 || value > _rules.size ())
+        {
+          _message = "There is no rule " + word + '.';
+          return true;
+        }
+
+        indexes.push_back (value - 1);
+      }
+
+      search (indexes);
+      auto pos = find (_top, true);
+      if (pos != std::string::npos)
+        top (pos, 0);
+      else if (_message == "")
+        _message = "No more hits.";
+    }
+  }
+
+  else if (key == "n" || key == "N")
+  {
+    if (_search.size () == 0)
+      _message = "Search for rules with / first.";
+    else
+    {
+      auto pos = find (_top, key == "n");
+      if (pos != std::string::npos)
+        top (pos, 0);
+      else if (_message == "")
+        _message = "No more hits.";
+    }
+  }
+
+  else if (key == "h" || key == "H")
+    _message = "q quit, j k line, space b page, g G start end, <n>g line, / rules, n N next previous hit";
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads a line on the status row.  Escape cancels.
+bool Pager::prompt (const std::string& text, std::string& answer)
+{
+  while (true)
+  {
+    writeAll (STDOUT_FILENO, "\x1b[" + std::to_string (_height + 1) + ";1H\x1b[K\x1b[?25h" + text + answer);
+
+    std::string pressed;
+    if (! keystroke (pressed))
+      return false;
+
+    auto c = pressed[0];
+    if (pressed.length () > 1)
+      continue;
+
+    if (c == '\r' || c == '\n')
+      break;
+
+    if (c == '\x1b' || c == '\x03')
+    {
+      answer = "";
+      break;
+    }
+
+    if ((c == '\x7f' || c == '\b') && answer.length ())
+      answer.pop_back ();
+    else if (c >= ' ' && c < '\x7f')
+      answer += c;
+  }
+
+  writeAll (STDOUT_FILENO, "\x1b[?25l");
+  return answer != "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders the lines from the top that fit, and the status row, in one write.
+void Pager::draw ()
+{
+  std::string frame = "\x1b[H";
+  std::size_t shown = 0;
+  auto skip = _row;
+  auto pos = _top;
+  for (; shown < _height && pos < _size; pos = next (pos))
+  {
+    auto& output = render (pos);
+    std::string::size_type begin = 0;
+    for (std::size_t row = 0; shown < _height && begin < output.length (); ++row)
+    {
+      auto eol = output.find ('\n', begin);
+      if (row >= skip)
+      {
+        clip (output, begin, eol, _width, frame);
+        frame += "\r\n";
+        ++shown;
+      }
+
+      begin = eol + 1;
+    }
+
+    skip = 0;
+  }
+
+  for (; shown < _height; ++shown)
+    frame += "~\x1b[K\r\n";
+
+  std::string text = _file;
+  std::size_t current;
+  if (number (_top, current))
+    text += "  line " + std::to_string (current);
+
+  std::size_t lines;
+  bool complete = indexed (lines);
+  if (complete)
+    text += " of " + std::to_string (lines);
+
+  text += "  " + std::to_string (_size ? pos * 100 / _size : 100) + '%';
+  if (! complete)
+    text += "  (indexing " + std::to_string (_size ? _scanned * 100 / _size : 100) + "%)";
+
+  if (_search.size ())
+  {
+    text += "  rules";
+    for (std::size_t i = 0; i < _search.size (); ++i)
+      text += (i ? ',' : ' ') + std::to_string (_search[i] + 1);
+  }
+
+  if (_message != "")
+    text += "  " + _message;
+
+  frame += "\x1b[7m";
+  clip (text, 0, text.length (), _width, frame);
+  writeAll (STDOUT_FILENO, frame);
+}
+
+////////////////////////////////////////////////////////////////////////////////
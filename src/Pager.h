@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_PAGER
+#define INCLUDED_PAGER
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <Filter.h>
+#include <Rule.h>
+
+// Pages through a file, which is mapped, not read.  Lines are found by their
+// byte offsets, from the newlines around them, so that any part of the file,
+// including its end, can be shown at once.  Line numbers come from an index of
+// every INTERVAL-th line start, built on a separate thread.  Rules are only
+// applied to the lines shown, and searched for, and a few hundred rendered
+// lines are cached.
+class Pager
+{
+public:
+  Pager (std::vector <Rule>&, const std::vector <std::string>&);
+  Pager (const Pager&) = delete;
+  Pager& operator= (const Pager&) = delete;
+  ~Pager ();
+
+  void open (const std::string&);
+  int run ();
+
+  std::size_t size () const;
+  std::size_t next (std::size_t) const;
+  std::size_t previous (std::size_t) const;
+  const std::string& render (std::size_t);
+  std::size_t rows (std::size_t);
+  bool number (std::size_t, std::size_t&);
+  std::size_t seek (std::size_t);
+  bool indexed (std::size_t&) const;
+  void wait ();
+  void search (const std::vector <std::size_t>&);
+  std::size_t find (std::size_t, bool);
+
+  // The view: the line at the top, and its first row shown.
+  void top (std::size_t, std::size_t);
+  std::size_t top () const;
+  void down (std::size_t);
+  void up (std::size_t);
+  void end ();
+  bool atEnd ();
+  void height (std::size_t);
+
+private:
+  struct Rendered
+  {
+    std::size_t _offset;
+    std::string _output;
+  };
+
+  void index ();
+  void line (std::size_t, std::string&) const;
+  bool cancelled ();
+  void draw ();
+  void status (std::string&);
+  bool keystroke (std::string&);
+  bool key (const std::string&, std::size_t&);
+  bool prompt (const std::string&, std::string&);
+
+private:
+  std::vector <Rule>&       _rules;
+  Filter                    _filter;
+  std::string               _file        {};
+  const char*               _data        {nullptr};
+  std::size_t               _size        {0};
+  std::vector <Rendered>    _cache       {};
+  std::string               _line        {};
+  std::vector <std::size_t> _search      {};  // Rule indexes
+  Rule::Scratch             _scratch     {};
+  std::size_t               _top         {0};
+  std::size_t               _row         {0};
+  std::size_t               _height      {24};  // Rows of lines
+  std::size_t               _width       {80};
+  std::string               _message     {};
+  std::string               _input       {};  // Keys read, not acted on
+  int                       _tty         {-1};
+
+  // Shared with the indexing thread.
+  std::thread               _thread      {};
+  mutable std::mutex        _mutex       {};
+  std::vector <std::size_t> _starts      {};  // Of lines 0, INTERVAL, ...
+  std::size_t               _lines       {0};
+  std::atomic <std::size_t> _scanned     {0};
+  std::atomic <bool>        _indexed     {false};
+  std::atomic <bool>        _stop        {false};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
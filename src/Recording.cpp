@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Recording.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char*                  MAGIC      = "CLOGREC2";
+static const std::string::size_type BLOCK_SIZE = 1 << 16;
+
+////////////////////////////////////////////////////////////////////////////////
+// Errors can no longer be reported here, so flush explicitly to see them.
+Recording::~Recording ()
+{
+  if (_fd != -1)
+  {
+    try
+    {
+      if (_open)
+        record (0, nullptr, 0, true);
+
+      flush ();
+    }
+
+    catch (...)
+    {
+    }
+
+    close (_fd);
+  }
+
+  if (_data)
+    munmap ((void*) _data, _size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Starts a new recording, replacing the file.
+void Recording::create (const std::string& path)
+{
+  _path = path;
+  _fd = ::open (path.c_str (), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (_fd == -1)
+    throw std::string ("Cannot open ") + path + ": " + strerror (errno);
+
+  _buffer = MAGIC;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Takes one line, or segment of a long line, as Sink::add does, and the time
+// its first segment arrived.  The first line recorded has no delay.
+void Recording::add (
+  const std::string& line,
+  std::string::size_type overlap,
+  std::string::size_type cut,
+  std::chrono::steady_clock::time_point arrival)
+{
+  std::uint64_t delay = 0;
+  if (! _open)
+  {
+    if (_started)
+      delay = std::chrono::duration_cast <std::chrono::microseconds> (arrival - _previous).count ();
+
+    _previous = arrival;
+    _started = true;
+  }
+
+  auto end = std::min (cut, line.length ());
+  auto begin = std::min (overlap, end);
+  _open = cut != std::string::npos;
+  record (delay, line.data () + begin, end - begin, ! _open);
+
+  if (_buffer.length () >= BLOCK_SIZE)
+    flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Recording::record (std::uint64_t delay, const char* data, std::size_t size, bool last)
+{
+  char header[20];
+  auto length = encode (header, delay);
+  length += encode (header + length, ((std::uint64_t) size << 1) | (last ? 0 : 1));
+  _buffer.append (header, length);
+  _buffer.append (data, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Recording::flush ()
+{
+  std::string::size_type done = 0;
+  while (done < _buffer.length ())
+  {
+    auto written = write (_fd, _buffer.data () + done, _buffer.length () - done);
+    if (written == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      _buffer.clear ();
+      throw std::string ("Cannot write ") + _path + ": " + strerror (errno);
+    }
+
+    done += written;
+  }
+
+  _buffer.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Maps a recording, to be read from the start.
+void Recording::open (const std::string& path)
+{
+  int fd = ::open (path.c_str (), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    throw std::string ("Cannot open ") + path + ": " + strerror (errno);
+
+  struct stat st;
+  if (fstat (fd, &st) == -1 || (std::size_t) st.st_size < strlen (MAGIC))
+  {
+    close (fd);
+    throw std::string ("Cannot replay ") + path + ", which is not a recording.";
+  }
+
+  _size = (std::size_t) st.st_size;
+  auto mapped = mmap (nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapped == MAP_FAILED)
+    throw std::string ("Cannot map ") + path + ": " + strerror (errno);
+
+  _data = (const char*) mapped;
+  if (memcmp (_data, MAGIC, strlen (MAGIC)))
+    throw std::string ("Cannot replay ") + path + ", which is not a recording.";
+
+  madvise (mapped, _size, MADV_SEQUENTIAL);
+  _path = path;
+  _cursor = _data + strlen (MAGIC);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The next line, or piece of a long line, without its \n, its delay in
+// microseconds after the line before it, and whether it ends the line.  A
+// record cut short ends the recording.
+bool Recording::next (
+  std::uint64_t& delay,
+  const char*& line,
+  std::size_t& length,
+  bool& last)
+{
+  auto end = _data + _size;
+  const char* cursor = _cursor;
+  std::uint64_t size;
+  if (! decode (cursor, end, delay) ||
+      ! decode (cursor, end, size)  ||
+      (size >> 1) > (std::uint64_t) (end - cursor))
+    return false;
+
+  line = cursor;
+  length = size >> 1;
+  last = ! (size & 1);
+  _cursor = cursor + length;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Seven bits per byte, lowest first, with the high bit set on all but the last.
+std::size_t Recording::encode (char* out, std::uint64_t value)
+{
+  std::size_t length = 0;
+  while (value >= 0x80)
+  {
+    out[length++] = (char) (value | 0x80);
+    value >>= 7;
+  }
+
+  out[length++] = (char) value;
+  return length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Recording::decode (const char*& cursor, const char* end, std::uint64_t& value)
+{
+  value = 0;
+  for (int shift = 0; cursor < end && shift < 64; shift += 7)
+  {
+    auto byte = (unsigned char) *cursor++;
+    value |= (std::uint64_t) (byte & 0x7f) << shift;
+    if (! (byte & 0x80))
+      return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_RECORDING
+#define INCLUDED_RECORDING
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// A file of input lines, each with the time since the line before it arrived,
+// so that a live stream can be fed to clog again at its original pace.  After
+// the magic "CLOGREC2", every line is one or more records of three parts: the
+// delay in microseconds, and the length in bytes shifted left by one, with the
+// low bit set if the line continues in the next record, both as base-128
+// varints, then the bytes, without the \n.  A long line is recorded segment
+// by segment, as it is read, so it is never held whole, and only its first
+// record has a delay.  A recording is written in blocks, and whenever the
+// caller is about to wait for input, and is read through a mapping.
+class Recording
+{
+public:
+  Recording () = default;
+  Recording (const Recording&) = delete;
+  Recording& operator= (const Recording&) = delete;
+  ~Recording ();
+
+  void create (const std::string&);
+  void add (const std::string&, std::string::size_type, std::string::size_type,
+            std::chrono::steady_clock::time_point);
+  void flush ();
+
+  void open (const std::string&);
+  bool next (std::uint64_t&, const char*&, std::size_t&, bool&);
+
+  static std::size_t encode (char*, std::uint64_t);
+  static bool decode (const char*&, const char*, std::uint64_t&);
+
+private:
+  void record (std::uint64_t, const char*, std::size_t, bool);
+
+private:
+  std::string _path     {};
+  int         _fd       {-1};
+
+  // Writing: whether a line is part way through its segments.
+  std::string _buffer   {};
+  bool        _open     {false};
+  std::chrono::steady_clock::time_point _previous {};
+  bool        _started  {false};
+
+  // Reading.
+  const char* _data     {nullptr};
+  std::size_t _size     {0};
+  const char* _cursor   {nullptr};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Ring.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Holds up to count chunks of size bytes.  Must be called before either thread
+// starts.
+void Ring::reserve (std::size_t count, std::size_t size)
+{
+  _size = size;
+  _chunks.resize (count < 2 ? 2 : count);
+  _lengths.resize (_chunks.size ());
+  _arrivals.resize (_chunks.size ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Waits for a free chunk, and returns it for the producer to fill, or returns
+// nullptr if the consumer has gone away.
+char* Ring::produce ()
+{
+  if (full () && ! _cancelled)
+  {
+    std::unique_lock <std::mutex> lock (_mutex);
+    _producing = true;
+    _changed.wait (lock, [this] { return ! full () || _cancelled; });
+    _producing = false;
+  }
+
+  if (_cancelled)
+    return nullptr;
+
+  auto& chunk = _chunks[_tail.load (std::memory_order_relaxed) % _chunks.size ()];
+  if (chunk.length () != _size)
+    chunk.resize (_size);
+
+  return &chunk[0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Hands the chunk from produce over to the consumer, unless it is empty.
+void Ring::publish (std::size_t length)
+{
+  if (length == 0)
+    return;
+
+  auto tail = _tail.load (std::memory_order_relaxed);
+  _lengths[tail % _chunks.size ()] = length;
+  _arrivals[tail % _chunks.size ()] = std::chrono::steady_clock::now ();
+
+  auto queued = _queued.fetch_add (length) + length;
+  if (queued > _high.load (std::memory_order_relaxed))
+    _high.store (queued, std::memory_order_relaxed);
+
+  _tail.store (tail + 1);
+  if (_consuming)
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _changed.notify_all ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Marks the end of the chunks, with the error that ended them, if any.
+void Ring::finish (const std::string& error)
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  _error = error;
+  _done = true;
+  _changed.notify_all ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Waits for the next chunk, which stays valid until release.  Returns false
+// once all chunks are consumed, or throws the error that ended them.
+bool Ring::consume (const char*& data, std::size_t& length, Time& arrival)
+{
+  if (empty () && ! _done)
+  {
+    std::unique_lock <std::mutex> lock (_mutex);
+    _consuming = true;
+    _changed.wait (lock, [this] { return ! empty () || _done; });
+    _consuming = false;
+  }
+
+  if (empty ())
+  {
+    if (_error != "")
+      throw _error;
+
+    return false;
+  }
+
+  auto index = _head.load (std::memory_order_relaxed) % _chunks.size ();
+  data = _chunks[index].data ();
+  length = _lengths[index];
+  arrival = _arrivals[index];
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Ring::release ()
+{
+  auto head = _head.load (std::memory_order_relaxed);
+  _queued -= _lengths[head % _chunks.size ()];
+  _head.store (head + 1);
+  if (_producing)
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _changed.notify_all ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Called by the consumer, to release a producer waiting for a free chunk.
+void Ring::cancel ()
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  _cancelled = true;
+  _changed.notify_all ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Bytes waiting for the consumer.
+std::size_t Ring::queued () const
+{
+  return _queued.load (std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The most bytes ever waiting.
+std::size_t Ring::high () const
+{
+  return _high.load (std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Ring::empty () const
+{
+  return _head == _tail;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Ring::full () const
+{
+  return _tail - _head == _chunks.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_RING
+#define INCLUDED_RING
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+// Passes chunks of bytes from one producer thread to one consumer thread.
+// Chunks are claimed and handed over through two atomic counters, without a
+// lock; the mutex is only taken by a side that has to sleep, because the ring
+// is empty or full, and by the other side to wake it.  Chunk memory is
+// allocated on first use, so the budget is only spent when the consumer falls
+// behind.
+class Ring
+{
+public:
+  typedef std::chrono::steady_clock::time_point Time;
+
+  void reserve (std::size_t, std::size_t);
+  char* produce ();
+  void publish (std::size_t);
+  void finish (const std::string&);
+  bool consume (const char*&, std::size_t&, Time&);
+  void release ();
+  void cancel ();
+  std::size_t queued () const;
+  std::size_t high () const;
+
+private:
+  bool empty () const;
+  bool full () const;
+
+private:
+  std::size_t               _size      {0};
+  std::vector <std::string> _chunks    {};
+  std::vector <std::size_t> _lengths   {};
+  std::vector <Time>        _arrivals  {};
+  std::atomic <std::size_t> _head      {0};  // Chunks consumed
+  std::atomic <std::size_t> _tail      {0};  // Chunks published
+  std::atomic <std::size_t> _queued    {0};  // Bytes published, not consumed
+  std::atomic <std::size_t> _high      {0};
+  std::atomic <bool>        _done      {false};
+  std::atomic <bool>        _cancelled {false};
+  std::atomic <bool>        _producing {false};  // Producer asleep
+  std::atomic <bool>        _consuming {false};  // Consumer asleep
+  std::mutex                _mutex     {};
+  std::condition_variable   _changed   {};
+  std::string               _error     {};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -26,13 +26,114 @@
 
 #include <cmake.h>
 #include <Rule.h>
+#include <Fold.h>
+#include <Text.h>
 #include <Pig.h>
+#include <FS.h>
 #include <RX.h>
 #include <shared.h>
+#include <algorithm>
+#include <limits>
 
 ////////////////////////////////////////////////////////////////////////////////
-// <section> rule /<pattern>/  --> <color> <context>
+// Finds the next whitespace-delimited token at or after end.
+static bool token (
+  const std::string& line,
+  std::string::size_type& begin,
+  std::string::size_type& end)
+{
+  begin = end;
+  while (begin < line.length () && (line[begin] == ' ' || line[begin] == '\t'))
+    ++begin;
+
+  end = begin;
+  while (end < line.length () && line[end] != ' ' && line[end] != '\t')
+    ++end;
+
+  return begin < end;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads a decimal number at offset: an optional sign, digits, and an optional
+// fraction.  Returns the offset past it, or offset itself if there is none.
+// The digits are accumulated as one integer and scaled once at the end, so
+// that "0.3" in a line compares equal to "0.3" in a rule.
+static std::string::size_type number (
+  const std::string& text,
+  std::string::size_type offset,
+  double& value)
+{
+  auto pos = offset;
+  bool negative = false;
+  if (pos < text.length () && (text[pos] == '-' || text[pos] == '+'))
+    negative = text[pos++] == '-';
+
+  auto digits = pos;
+  double mantissa = 0;
+  while (pos < text.length () && isDigit (text[pos]))
+    mantissa = mantissa * 10 + (text[pos++] - '0');
+
+  if (pos == digits)
+    return offset;
+
+  double scale = 1;
+  if (pos + 1 < text.length () &&
+      text[pos] == '.'          &&
+      isDigit (text[pos + 1]))
+  {
+    ++pos;
+    while (pos < text.length () && isDigit (text[pos]))
+    {
+      mantissa = mantissa * 10 + (text[pos++] - '0');
+      scale *= 10;
+    }
+  }
+
+  value = (negative ? -mantissa : mantissa) / scale;
+  return pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// An 'i' directly after the closing quote makes the pattern case-insensitive.
+static bool skipFlags (Pig& pig, bool& caseSensitive)
+{
+  caseSensitive = ! pig.skip ('i');
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool contextNamed (const std::string& word, Rule::Context& context)
+{
+  for (auto candidate : {Rule::Context::line,
+                         Rule::Context::match,
+                         Rule::Context::suppress,
+                         Rule::Context::blank,
+                         Rule::Context::datetime,
+                         Rule::Context::time})
+  {
+    if (word == Rule::name (candidate))
+    {
+      context = candidate;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// <section> rule /<pattern>/  --> <color> <context> [final]
 // taskd     rule /code:"2.."/ --> green   line
+// taskd     rule /error/i     --> red     line     final
+// taskd     rule /panic/      --> red     line     context=3
+// taskd     rule lines noise.txt --> suppress
+// taskd     rule "took=" > 500 --> red match
+// taskd     rule field 9 >= 500 --> red line
+// taskd     rule /ERROR/ within 0-60 --> red line
+// taskd     rule "db" after 2 "|" --> blue match
+//
+// The rule is compiled into its context and matcher, which select a kernel
+// specialized for both, so applying it involves no string comparisons.
 Rule::Rule (const std::string& line)
 {
   _fragment = "";
@@ -40,89 +141,123 @@ Rule::Rule (const std::string& line)
   Pig pig (line);
   pig.skipWS ();
 
+  bool caseSensitive = true;
   std::string pattern;
+  std::string written;
+  std::string part;
   if (pig.getUntilWS (_section) &&
       pig.skipWS ()             &&
       pig.skipLiteral ("rule")  &&
       pig.skipWS ())
   {
     // <section> rule /<pattern>/
-    if (pig.getQuoted ('/', pattern) &&
-        pig.skipWS ()                &&
+    if (pig.getQuoted ('/', pattern)    &&
+        skipFlags (pig, caseSensitive) &&
+        pig.skipWS ()                  &&
+        range (pig, part)              &&
         pig.skipLiteral ("-->"))
     {
-      pig.skipWS ();
-
-      std::string rest;
-      pig.getRemainder (rest);
-
-      std::string color_name;
-      std::vector <std::string> words = split (rest, ' ');
-      for (auto& word : words)
-      {
-        if (word.length ())
-        {
-               if (word == "line")     _context = word;
-          else if (word == "match")    _context = word;
-          else if (word == "suppress") _context = word;
-          else if (word == "blank")    _context = word;
-          else
-          {
-            if (color_name.length ())
-              color_name += " ";
-
-            color_name += word;
-          }
-        }
-      }
-
-      _color = Color (color_name);
+      action (pig);
+      _pattern = '/' + pattern + '/' + (caseSensitive ? "" : "i");
+      if (part != "")
+        _pattern += ' ' + part;
 
       // Now for "match" context patterns, add an enclosing ( ... ) if not
       // already present.
-      if (_context == "match")
+      if (_context == Context::match)
         if (pattern.find ('(') == std::string::npos)
           pattern = "(" + pattern + ")";
 
-      _rx = RX (pattern, true);
+      _rx = RX (pattern, caseSensitive);
+      _matcher = Matcher::regex;
+      compile ();
       return;
     }
 
     // <section> rule "<pattern>"
-    else if (pig.getQuoted ('"', pattern) &&
-             pig.skipWS ()                &&
+    // <section> rule "<key>" <op> <number>
+    else if (pig.getQuoted ('"', pattern)    &&
+             skipFlags (pig, caseSensitive) &&
+             pig.skipWS ()                  &&
+             comparison (pig, written)      &&
+             range (pig, part)              &&
              pig.skipLiteral ("-->"))
     {
-      pig.skipWS ();
+      // A threshold needs a key, and the key is case-sensitive.
+      if (written != "" && (pattern == "" || ! caseSensitive))
+        throw int (1);
 
-      std::string rest;
-      pig.getRemainder (rest);
+      action (pig);
+      _pattern = '"' + pattern + '"' + (caseSensitive ? "" : "i");
 
-      std::string color_name;
-      auto words = split (rest);
-      for (auto& word : words)
+      // An empty fragment falls back to the empty regex, matching any line.
+      if (written != "")
       {
-        if (word.length ())
-        {
-               if (word == "line")     _context = word;
-          else if (word == "match")    _context = word;
-          else if (word == "suppress") _context = word;
-          else if (word == "blank")    _context = word;
-          // TODO Support _context "datetime", "time"
-          else
-          {
-            if (color_name.length ())
-              color_name += " ";
-
-            color_name += word;
-          }
-        }
+        _pattern += ' ' + written;
+        _matcher = Matcher::keyed;
       }
+      else if (pattern == "")
+        _matcher = Matcher::regex;
+      else if (caseSensitive)
+        _matcher = Matcher::fragment;
+      else
+        _matcher = Matcher::folded;
 
-      _color = Color (color_name);
-      _fragment = pattern;
+      if (part != "")
+        _pattern += ' ' + part;
+
+      _fragment = caseSensitive ? pattern : foldCase (pattern);
+      _period = period (_fragment);
+      compile ();
       return;
     }
+
+    // <section> rule lines <file>
+    // <section> rule tokens <file>
+    // <section> rule field <n> <op> <number>
+    else if (pig.getUntilWS (pattern) &&
+             pig.skipWS ())
+    {
+      int field = 0;
+      if ((pattern == "lines" || pattern == "tokens") &&
+          pig.getUntilWS (_fragment)                  &&
+          pig.skipWS ()                               &&
+          range (pig, part)                           &&
+          pig.skipLiteral ("-->"))
+      {
+        action (pig);
+        _pattern = pattern + ' ' + _fragment;
+        if (part != "")
+          _pattern += ' ' + part;
+        _matcher = pattern == "lines" ? Matcher::lines : Matcher::tokens;
+
+        // File::File expands relative paths, and ~user, as for include.
+        _list = std::make_shared <StringSet> ();
+        _list->load (File (_fragment)._data);
+        _fragment = "";
+        compile ();
+        return;
+      }
+
+      else if (pattern == "field"           &&
+               pig.getDigits (field)        &&
+               field > 0                    &&
+               pig.skipWS ()                &&
+               comparison (pig, written)    &&
+               written != ""                &&
+               range (pig, part)            &&
+               pig.skipLiteral ("-->"))
+      {
+        action (pig);
+        _pattern = "field " + std::to_string (field) + ' ' + written;
+        if (part != "")
+          _pattern += ' ' + part;
+        _matcher = Matcher::field;
+        _field = field;
+        compile ();
+        return;
+      }
+    }
   }
 
   // Indicates that 'line' was not a rule def, but a blank line or similar.
@@ -130,112 +265,557 @@ Rule::Rule (const std::string& line)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// There are two kinds of matching:
-//   - regex     (when _fragment is     "")
-//   - substring (when _fragment is not "")
-//
-// There are several corresponding actions:
-//   - suppress  Eats the whole line, including \n
-//   - line      Colorizes the line
-//   - match     Colorizes the matching part
-//   - blank     Adds a blank line before and after
-//
-bool Rule::apply (Composite& composite, bool& blanks, const std::string& section, const std::string& line)
+// --> <color> <context> [final] [context=<n>]
+void Rule::action (Pig& pig)
 {
-  if (_section == section)
+  pig.skipWS ();
+
+  std::string rest;
+  pig.getRemainder (rest);
+
+  std::string color_name;
+  for (auto& word : split (rest))
   {
-    if (_context == "suppress")
+    if (word.length ())
     {
-      if (_fragment != "")
+      if (word == "final" || word == "stop")
+        _final = true;
+
+      else if (word.compare (0, 8, "context=") == 0)
       {
-        if (line.find (_fragment) != std::string::npos)
-        {
-          composite.clear ();
-          return true;
-        }
+        double lines;
+        auto end = number (word, 8, lines);
+        if (end == 8                                 ||
+            end != word.length ()                    ||
+            lines < 0                                ||
+            lines > std::numeric_limits <int>::max () ||
+            lines != (int) lines)
+          throw std::string ("Invalid context '") + word.substr (8) + "' in rule.";
+
+        _around = (int) lines;
       }
-      else
+
+      else if (! contextNamed (word, _context))
       {
-        if (_rx.match (line))
-        {
-          composite.clear ();
-          return true;
-        }
+        if (color_name.length ())
+          color_name += " ";
+
+        color_name += word;
       }
     }
+  }
 
-    else if (_context == "line")
+  _color = Color (color_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// An optional <op> <number>, which makes the rule a threshold, and is written
+// back as it was given.  Only fails if an operator has no number after it.
+bool Rule::comparison (Pig& pig, std::string& written)
+{
+  // Two-character operators first, so that ">=" is not read as ">".
+  static const std::pair <const char*, Compare> operators[] =
+  {
+    {">=", Compare::atLeast},
+    {"<=", Compare::atMost},
+    {"==", Compare::equal},
+    {"!=", Compare::unequal},
+    {">",  Compare::more},
+    {"<",  Compare::less},
+  };
+
+  for (auto& op : operators)
+  {
+    if (pig.skipLiteral (op.first))
     {
-      if (_fragment != "")
-      {
-        if (line.find (_fragment) != std::string::npos)
-        {
-          composite.add (line, 0, _color);
-          return true;
-        }
-      }
-      else
-      {
-        if (_rx.match (line))
-        {
-          composite.add (line, 0, _color);
-          return true;
-        }
-      }
+      pig.skipWS ();
+
+      std::string threshold;
+      if (! pig.getNumber (threshold) ||
+          number (threshold, 0, _threshold) != threshold.length ())
+        return false;
+
+      pig.skipWS ();
+      _compare = op.second;
+      written = std::string (op.first) + ' ' + threshold;
+      return true;
     }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// An optional scope, which limits the rule to part of the line, and is written
+// back as it was given.  Only fails if a scope is incomplete.
+//   within <from>-<to>    The bytes at offsets from, up to but excluding to
+//   before <n> "<delim>"  The text before the nth delimiter
+//   after <n> "<delim>"   The text after the nth delimiter
+bool Rule::range (Pig& pig, std::string& written)
+{
+  int from;
+  int to;
+  if (pig.skipLiteral ("within"))
+  {
+    pig.skipWS ();
+    if (! pig.getDigits (from) ||
+        ! pig.skip ('-')       ||
+        ! pig.getDigits (to)   ||
+        to <= from)
+      return false;
 
-    else if (_context == "match")
+    _scope = Scope::within;
+    _from = from;
+    _to = to;
+    written = "within " + std::to_string (from) + '-' + std::to_string (to);
+  }
+
+  else
+  {
+    bool before = pig.skipLiteral ("before");
+    if (before || pig.skipLiteral ("after"))
     {
-      if (_fragment != "")
-      {
-        bool found = false;
-        auto pos = line.find (_fragment);
-        while (pos != std::string::npos)
-        {
-          composite.add (line.substr (pos, _fragment.length ()), pos, _color);
-          pos = line.find (_fragment, pos + 1);
-          found = true;
-        }
-
-        if (found)
-          return true;
-      }
-      else
-      {
-        std::vector <int> start;
-        std::vector <int> end;
-        if (_rx.match (start, end, line))
-        {
-          for (unsigned int i = 0; i < start.size (); ++i)
-            composite.add (line.substr (start[i], end[i] - start[i]), start[i], _color);
-
-          return true;
-        }
-      }
+      int n;
+      std::string delimiter;
+      pig.skipWS ();
+      if (! pig.getDigits (n)                 ||
+          n < 1                               ||
+          ! pig.skipWS ()                     ||
+          ! pig.getQuoted ('"', delimiter)    ||
+          delimiter == "")
+        return false;
+
+      _scope = before ? Scope::before : Scope::after;
+      _occurrence = n;
+      _delimiter = delimiter;
+      written = std::string (before ? "before " : "after ") + std::to_string (n) +
+                " \"" + delimiter + '"';
     }
+  }
+
+  pig.skipWS ();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copies the part of the line that a scoped rule inspects, so that matchers
+// see it as a line of its own.  A byte range costs only its own length.  The
+// search for the nth delimiter stops there, but reads the whole line when
+// there are fewer, and the part after it runs to the end of the line.  A line
+// too short for the scope, or with too few delimiters, has none, and is not
+// matched.
+bool Rule::scope (Scratch& scratch, const std::string& line) const
+{
+  auto begin = (std::string::size_type) 0;
+  auto end = line.length ();
+  if (_scope == Scope::within)
+  {
+    if (_from > line.length ())
+      return false;
+
+    begin = _from;
+    end = std::min (_to, line.length ());
+  }
+  else
+  {
+    auto pos = line.find (_delimiter);
+    for (unsigned int n = 1; n < _occurrence && pos != std::string::npos; ++n)
+      pos = line.find (_delimiter, pos + _delimiter.length ());
+
+    if (pos == std::string::npos)
+      return false;
+
+    if (_scope == Scope::before)
+      end = pos;
+    else
+      begin = pos + _delimiter.length ();
+  }
 
-    else if (_context == "blank")
+  scratch._scoped.assign (line, begin, end - begin);
+  scratch._origin = begin;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Section names are interned, so that sections are compared as numbers.
+unsigned int Rule::intern (const std::string& section)
+{
+  static std::vector <std::string> sections;
+  for (unsigned int i = 0; i < sections.size (); ++i)
+    if (sections[i] == section)
+      return i;
+
+  sections.push_back (section);
+  return sections.size () - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const char* Rule::name (Context context)
+{
+  switch (context)
+  {
+  case Context::line:     return "line";
+  case Context::match:    return "match";
+  case Context::suppress: return "suppress";
+  case Context::blank:    return "blank";
+  case Context::datetime: return "datetime";
+  case Context::time:     return "time";
+  case Context::none:     break;
+  }
+
+  return "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Rule::compile ()
+{
+  _sectionId = intern (_section);
+  bool scoped = _scope != Scope::none;
+
+  switch (_context)
+  {
+  case Context::none:     _kernel = select <Context::none>     (_matcher, scoped); break;
+  case Context::line:     _kernel = select <Context::line>     (_matcher, scoped); break;
+  case Context::match:    _kernel = select <Context::match>    (_matcher, scoped); break;
+  case Context::suppress: _kernel = select <Context::suppress> (_matcher, scoped); break;
+  case Context::blank:    _kernel = select <Context::blank>    (_matcher, scoped); break;
+  case Context::datetime: _kernel = select <Context::datetime> (_matcher, scoped); break;
+  case Context::time:     _kernel = select <Context::time>     (_matcher, scoped); break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Rule::Kernel Rule::compiled () const
+{
+  return _kernel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <Rule::Context C>
+Rule::Kernel Rule::select (Matcher matcher, bool scoped)
+{
+  switch (matcher)
+  {
+  case Matcher::fragment: return pick <C, Matcher::fragment> (scoped);
+  case Matcher::folded:   return pick <C, Matcher::folded>   (scoped);
+  case Matcher::lines:    return pick <C, Matcher::lines>    (scoped);
+  case Matcher::tokens:   return pick <C, Matcher::tokens>   (scoped);
+  case Matcher::keyed:    return pick <C, Matcher::keyed>    (scoped);
+  case Matcher::field:    return pick <C, Matcher::field>    (scoped);
+  case Matcher::regex:    break;
+  }
+
+  return pick <C, Matcher::regex> (scoped);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <Rule::Context C, Rule::Matcher M>
+Rule::Kernel Rule::pick (bool scoped)
+{
+  return scoped ? &Rule::scoped <C, M> : &Rule::kernel <C, M>;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The smallest period of a fragment, from its KMP failure function: "abab" has
+// period 2, "aaa" period 1, "abc" period 3.
+std::string::size_type Rule::period (const std::string& fragment)
+{
+  std::vector <std::string::size_type> border (fragment.length () + 1, 0);
+  std::string::size_type k = 0;
+  for (std::string::size_type i = 1; i < fragment.length (); ++i)
+  {
+    while (k > 0 && fragment[i] != fragment[k])
+      k = border[k];
+
+    if (fragment[i] == fragment[k])
+      ++k;
+
+    border[i + 1] = k;
+  }
+
+  return fragment.length () - border[fragment.length ()];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Only decides whether the rule matches the line, without finding every match
+// or coloring anything, which is all that counting needs.
+bool Rule::hits (Scratch& scratch, const std::string& line) const
+{
+  if (_scope != Scope::none && ! scope (scratch, line))
+    return false;
+
+  auto& text = _scope != Scope::none ? scratch._scoped : line;
+  bool matched = false;
+  switch (_matcher)
+  {
+  case Matcher::fragment: matched = found <Matcher::fragment> (text); break;
+  case Matcher::folded:   matched = found <Matcher::folded>   (text); break;
+  case Matcher::regex:    matched = found <Matcher::regex>    (text); break;
+  case Matcher::lines:    matched = found <Matcher::lines>    (text); break;
+  case Matcher::tokens:   matched = found <Matcher::tokens>   (text); break;
+  case Matcher::keyed:    matched = found <Matcher::keyed>    (text); break;
+  case Matcher::field:    matched = found <Matcher::field>    (text); break;
+  }
+
+  if (matched && (_context == Context::datetime || _context == Context::time))
+    return scratch._timestamp.scan (text);
+
+  return matched;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <Rule::Matcher M>
+bool Rule::found (const std::string& line) const
+{
+  if (M == Matcher::regex)
+    return _rx.match (line);
+
+  if (M == Matcher::lines)
+    return _list->contains (line.data (), line.length ());
+
+  if (M == Matcher::keyed || M == Matcher::field)
+    return numbers (line, nullptr);
+
+  if (M == Matcher::tokens)
+  {
+    std::string::size_type begin;
+    std::string::size_type end = 0;
+    while (token (line, begin, end))
+      if (_list->contains (line.data () + begin, end - begin))
+        return true;
+
+    return false;
+  }
+
+  return find <M> (line, 0) != std::string::npos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Finds the numbers that satisfy the threshold: after each occurrence of the
+// key, or at the start of the field.  With layers, each is colored, otherwise
+// the first one settles it.
+bool Rule::numbers (const std::string& line, Layers* layers) const
+{
+  double value;
+  if (_matcher == Matcher::field)
+  {
+    std::string::size_type begin;
+    std::string::size_type end = 0;
+    for (unsigned int n = 1; token (line, begin, end); ++n)
     {
-      if (_fragment != "")
+      if (n == _field)
       {
-        if (line.find (_fragment) != std::string::npos)
-        {
-          blanks = true;
-          return true;
-        }
+        auto stop = number (line, begin, value);
+        if (stop == begin || ! satisfies (value))
+          return false;
+
+        if (layers)
+          layers->add (begin, stop - begin, _color);
+
+        return true;
       }
-      else
+    }
+
+    return false;
+  }
+
+  bool found = false;
+  for (auto pos = line.find (_fragment);
+       pos != std::string::npos;
+       pos = line.find (_fragment, pos + 1))
+  {
+    auto start = pos + _fragment.length ();
+    auto stop = number (line, start, value);
+    if (stop != start && satisfies (value))
+    {
+      if (! layers)
+        return true;
+
+      layers->add (start, stop - start, _color);
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Rule::satisfies (double value) const
+{
+  switch (_compare)
+  {
+  case Compare::less:    return value <  _threshold;
+  case Compare::atMost:  return value <= _threshold;
+  case Compare::equal:   return value == _threshold;
+  case Compare::unequal: return value != _threshold;
+  case Compare::atLeast: return value >= _threshold;
+  case Compare::more:    return value >  _threshold;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Finds the fragment in line, at or after from.
+template <Rule::Matcher M>
+std::string::size_type Rule::find (const std::string& line, std::string::size_type from) const
+{
+  if (M == Matcher::folded)
+    return findFolded (line, _fragment, from);
+
+  return line.find (_fragment, from);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Compares length bytes of line at offset with the fragment at start.
+template <Rule::Matcher M>
+bool Rule::same (
+  const std::string& line,
+  std::string::size_type offset,
+  std::string::size_type start,
+  std::string::size_type length) const
+{
+  if (M == Matcher::folded)
+    return equalFolded (line.data () + offset, _fragment.data () + start, length);
+
+  return line.compare (offset, length, _fragment, start, length) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// There are seven kinds of matching:
+//   - regex     (also for an empty fragment)
+//   - fragment  Substring
+//   - folded    Substring, ignoring case
+//   - lines     The whole line is in the list
+//   - tokens    A token of the line is in the list
+//   - keyed     The number after the key satisfies the threshold
+//   - field     The number in the field satisfies the threshold
+//
+// There are several corresponding actions:
+//   - suppress  Eats the whole line, including \n
+//   - line      Colorizes the line
+//   - match     Colorizes the matching part
+//   - blank     Adds a blank line before and after
+//   - datetime  Colorizes the timestamp
+//   - time      Colorizes the time of day of the timestamp
+//
+// Each combination is a kernel of its own, in which the tests on C and M are
+// resolved at compile time.
+template <Rule::Context C, Rule::Matcher M>
+bool Rule::kernel (const Rule& rule, Scratch& scratch, Layers& layers, bool& blanks, const std::string& line)
+{
+  if (C == Context::none)
+    return false;
+
+  if (C == Context::match && (M == Matcher::keyed || M == Matcher::field))
+    return rule.numbers (line, &layers);
+
+  if (C == Context::match && M == Matcher::tokens)
+  {
+    bool found = false;
+    std::string::size_type begin;
+    std::string::size_type end = 0;
+    while (token (line, begin, end))
+    {
+      if (rule._list->contains (line.data () + begin, end - begin))
       {
-        if (_rx.match (line))
-        {
-          blanks = true;
-          return true;
-        }
+        layers.add (begin, end - begin, rule._color);
+        found = true;
       }
     }
+
+    return found;
   }
 
-  return false;
+  if (C == Context::match && (M == Matcher::fragment || M == Matcher::folded))
+  {
+    // Overlapping occurrences are merged into one layer.  They can only
+    // follow each other at multiples of the fragment period, so each
+    // extension compares just the next period's worth of bytes, and the
+    // search resumes past the point where another overlap is possible.
+    // This keeps enumeration linear even for "aaaa..." against "aa".
+    auto length = rule._fragment.length ();
+    auto period = rule._period;
+    bool found = false;
+    auto pos = rule.find <M> (line, 0);
+    while (pos != std::string::npos)
+    {
+      auto end = pos + length;
+      while (end + period <= line.length () &&
+             rule.same <M> (line, end, length - period, period))
+        end += period;
+
+      layers.add (pos, end - pos, rule._color);
+      pos = rule.find <M> (line, end - period + 1);
+      found = true;
+    }
+
+    return found;
+  }
+
+  if (C == Context::match && M == Matcher::regex)
+  {
+    scratch._start.clear ();
+    scratch._end.clear ();
+    if (! rule._rx.match (scratch._start, scratch._end, line))
+      return false;
+
+    for (unsigned int i = 0; i < scratch._start.size (); ++i)
+      layers.add (scratch._start[i], scratch._end[i] - scratch._start[i], rule._color);
+
+    return true;
+  }
+
+  if (! rule.found <M> (line))
+    return false;
+
+  if (C == Context::suppress)
+    layers.clear ();
+
+  else if (C == Context::line || C == Context::match)
+    layers.add (0, line.length (), rule._color);
+
+  else if (C == Context::blank)
+    blanks = true;
+
+  else if (C == Context::datetime || C == Context::time)
+  {
+    auto& timestamp = scratch._timestamp;
+    if (! timestamp.scan (line))
+      return false;
+
+    if (C == Context::datetime)
+      layers.add (timestamp._offset, timestamp._length, rule._color);
+    else
+      layers.add (timestamp._clock, timestamp._clockLength, rule._color);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A scoped rule applies its kernel to the part of the line it inspects, with
+// matches placed back at their offsets in the whole line.  Only the line
+// action still colors the whole line.
+template <Rule::Context C, Rule::Matcher M>
+bool Rule::scoped (const Rule& rule, Scratch& scratch, Layers& layers, bool& blanks, const std::string& line)
+{
+  if (C == Context::none || ! rule.scope (scratch, line))
+    return false;
+
+  if (C == Context::line)
+  {
+    if (! rule.found <M> (scratch._scoped))
+      return false;
+
+    layers.add (0, line.length (), rule._color);
+    return true;
+  }
+
+  layers.origin (scratch._origin);
+  auto hit = kernel <C, M> (rule, scratch, layers, blanks, scratch._scoped);
+  layers.origin (0);
+  return hit;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -28,22 +28,100 @@
 #define INCLUDED_RULE
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <Color.h>
 #include <RX.h>
-#include <Composite.h>
+#include <Layers.h>
+#include <Timestamp.h>
+#include <StringSet.h>
+
+class Pig;
 
 class Rule
 {
 public:
+  // What the rule does with a line it matches.
+  enum class Context : unsigned char { none, line, match, suppress, blank, datetime, time };
+
+  // How it matches: a fragment, a case-folded fragment, a regex, the whole
+  // line or any whitespace-delimited token of it against a list, or the number
+  // after a key or in a field against a threshold.
+  enum class Matcher : unsigned char { fragment, folded, regex, lines, tokens, keyed, field };
+
+  // How a number is compared with the threshold.
+  enum class Compare : unsigned char { less, atMost, equal, unequal, atLeast, more };
+
+  // Which part of the line it inspects: all of it, a byte range, or the text
+  // before or after the nth delimiter.
+  enum class Scope : unsigned char { none, within, before, after };
+
+  // Working storage of the kernels for one line, owned by whoever applies
+  // the rules, so that a compiled rule is never changed by applying it, and
+  // one rule set may be applied by several filters.
+  struct Scratch
+  {
+    std::vector <int>      _start     {};  // Match offsets, retained across lines
+    std::vector <int>      _end       {};
+    Timestamp              _timestamp {};  // Last timestamp scanned
+    std::string            _scoped    {};  // The part of the line inspected,
+    std::string::size_type _origin    {0}; // and where it starts
+  };
+
+  typedef bool (*Kernel) (const Rule&, Scratch&, Layers&, bool&, const std::string&);
+
   explicit Rule (const std::string&);
-  bool apply (Composite&, bool&, const std::string&, const std::string&);
+  bool apply (Scratch& scratch, Layers& layers, bool& blanks, const std::string& line) const { return _kernel (*this, scratch, layers, blanks, line); }
+  bool hits (Scratch&, const std::string&) const;
+  Kernel compiled () const;
+
+  static unsigned int intern (const std::string&);
+  static const char* name (Context);
+
+private:
+  void action (Pig&);
+  bool comparison (Pig&, std::string&);
+  bool range (Pig&, std::string&);
+  bool scope (Scratch&, const std::string&) const;
+  bool numbers (const std::string&, Layers*) const;
+  bool satisfies (double) const;
+  void compile ();
+  template <Context C, Matcher M> static bool kernel (const Rule&, Scratch&, Layers&, bool&, const std::string&);
+  template <Context C, Matcher M> static bool scoped (const Rule&, Scratch&, Layers&, bool&, const std::string&);
+  template <Context C> static Kernel select (Matcher, bool);
+  template <Context C, Matcher M> static Kernel pick (bool);
+  template <Matcher M> bool found (const std::string&) const;
+  template <Matcher M> std::string::size_type find (const std::string&, std::string::size_type) const;
+  template <Matcher M> bool same (const std::string&, std::string::size_type, std::string::size_type, std::string::size_type) const;
+  static std::string::size_type period (const std::string&);
+
+  // The members read for every line come first, then those of the less
+  // common matchers, and last those only shown.
+  Kernel                 _kernel    {nullptr};
+  std::string::size_type _period    {0}; // Smallest period of _fragment
 
 public:
-  std::string _section  {};
-  Color       _color    {};
-  std::string _context  {};
-  RX          _rx       {};   // Regex for rule
-  std::string _fragment {};   // String pattern for rule (not regex)
+  Color        _color         {};
+  Context      _context       {Context::none};
+  Matcher      _matcher       {Matcher::regex};
+  Compare      _compare       {Compare::more}; // For keyed and field
+  Scope        _scope         {Scope::none};
+  bool         _final         {false}; // Ends evaluation of a line it hits
+  unsigned int _sectionId     {0};     // Interned _section
+  int          _around        {-1};    // Lines of context, -1 for --context
+  std::string  _fragment      {};      // String pattern for rule (not regex),
+                                       // folded if case-insensitive
+  mutable RX   _rx            {};      // Regex for rule, which RX::match
+                                       // compiles on first use
+  std::shared_ptr <StringSet> _list {};  // For lines and tokens, shared by copies
+  double       _threshold     {0};
+  unsigned int _field         {0};     // 1-based
+  unsigned int _occurrence    {0};     // For before and after, 1-based
+  std::size_t  _from          {0};     // For within, the bytes [_from, _to)
+  std::size_t  _to            {0};
+  std::string  _delimiter     {};
+  std::string  _section       {};
+  std::string  _pattern       {};      // The pattern as written, for display
 };
 
 #endif
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Sink.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+
+static const std::string::size_type BLOCK_SIZE = 1 << 16;
+
+////////////////////////////////////////////////////////////////////////////////
+Sink::Sink (
+  Mode mode,
+  const std::string& path,
+  const std::vector <std::size_t>& rules)
+: _mode (mode)
+, _path (path)
+, _rules (rules)
+{
+  _fd = open (path.c_str (), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (_fd == -1)
+    throw std::string ("Cannot open ") + path + ": " + strerror (errno);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Errors can no longer be reported here, so flush explicitly to see them.
+Sink::~Sink ()
+{
+  try
+  {
+    flush ();
+  }
+
+  catch (...)
+  {
+  }
+
+  close (_fd);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Sink::Mode Sink::mode () const
+{
+  return _mode;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector <std::size_t>& Sink::rules () const
+{
+  return _rules;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Takes one line, or segment of a long line, with the colored and plain
+// renderings the filter appended for it, and the rules it hit.
+void Sink::add (
+  const std::string& line,
+  const std::string& output,
+  const std::string& plain,
+  const Filter& filter,
+  std::string::size_type overlap,
+  std::string::size_type cut)
+{
+  if (_mode == Mode::ansi)
+    _buffer += output;
+
+  else if (_mode == Mode::plain)
+    _buffer += plain;
+
+  else
+  {
+    for (auto index : _rules)
+    {
+      if (filter.hit (index))
+      {
+        auto end = std::min (cut, line.length ());
+        if (overlap < end)
+          _buffer.append (line, overlap, end - overlap);
+
+        _open = true;
+        break;
+      }
+    }
+
+    if (cut == std::string::npos && _open)
+    {
+      _buffer += '\n';
+      _open = false;
+    }
+  }
+
+  if (_buffer.length () >= BLOCK_SIZE)
+    flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sink::flush ()
+{
+  std::string::size_type done = 0;
+  while (done < _buffer.length ())
+  {
+    auto written = write (_fd, _buffer.data () + done, _buffer.length () - done);
+    if (written == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      _buffer.clear ();
+      throw std::string ("Cannot write ") + _path + ": " + strerror (errno);
+    }
+
+    done += written;
+  }
+
+  _buffer.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_SINK
+#define INCLUDED_SINK
+
+#include <string>
+#include <vector>
+#include <Filter.h>
+
+// An additional output file, fed from the same rule evaluation as the main
+// output.  An ansi sink receives the colored output, a plain sink the same
+// lines without colors, and a rules sink the original text of every line hit
+// by any of its rules, whether suppressed or not.  Output is appended to the
+// file, in blocks, and whenever the caller is about to wait for input.
+class Sink
+{
+public:
+  enum class Mode { ansi, plain, rules };
+
+  Sink (Mode, const std::string&, const std::vector <std::size_t>&);
+  Sink (const Sink&) = delete;
+  Sink& operator= (const Sink&) = delete;
+  ~Sink ();
+
+  Mode mode () const;
+  const std::vector <std::size_t>& rules () const;
+  void add (const std::string&, const std::string&, const std::string&, const Filter&,
+            std::string::size_type, std::string::size_type);
+  void flush ();
+
+private:
+  Mode                      _mode   {Mode::ansi};
+  std::string               _path   {};
+  int                       _fd     {-1};
+  std::vector <std::size_t> _rules  {};
+  std::string               _buffer {};
+  bool                      _open   {false};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <StringSet.h>
+#include <Text.h>
+#include <cstring>
+#include <fstream>
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads one string per line.  Empty lines, and a trailing \r, are ignored.
+void StringSet::load (const std::string& file)
+{
+  std::ifstream in (file.c_str ());
+  if (! in.good ())
+    throw std::string ("Cannot open list ") + file + '.';
+
+  std::string line;
+  while (std::getline (in, line)) // Strips \n
+  {
+    if (line.length () && line.back () == '\r')
+      line.pop_back ();
+
+    if (line.length ())
+      insert (line.data (), line.length ());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StringSet::insert (const char* data, std::size_t length)
+{
+  if (contains (data, length))
+    return;
+
+  if (2 * (size () + 1) > _slots.size ())
+    grow ();
+
+  auto h = fnv1a (data, length);
+  auto mask = _slots.size () - 1;
+  auto i = h & mask;
+  while (_slots[i]._index)
+    i = (i + 1) & mask;
+
+  _pool.append (data, length);
+  _offsets.push_back (_pool.length ());
+  _slots[i] = {(std::uint32_t) h, (std::uint32_t) size ()};
+
+  // Independent of the order of the list.
+  _fingerprint ^= h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool StringSet::contains (const char* data, std::size_t length) const
+{
+  if (_slots.size () == 0)
+    return false;
+
+  auto h = fnv1a (data, length);
+  auto mask = _slots.size () - 1;
+  for (auto i = h & mask; _slots[i]._index; i = (i + 1) & mask)
+  {
+    if (_slots[i]._hash != (std::uint32_t) h)
+      continue;
+
+    auto begin = _offsets[_slots[i]._index - 1];
+    auto end   = _offsets[_slots[i]._index];
+    if (end - begin == length && memcmp (_pool.data () + begin, data, length) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t StringSet::size () const
+{
+  return _offsets.size () - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Changes when the strings do, so that indexes built with the set expire.
+std::uint64_t StringSet::fingerprint () const
+{
+  return _fingerprint ^ size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Doubles the table, and inserts every string again.
+void StringSet::grow ()
+{
+  std::vector <Slot> slots (_slots.size () ? _slots.size () * 2 : 16, Slot {0, 0});
+  auto mask = slots.size () - 1;
+  for (std::uint32_t index = 1; index <= size (); ++index)
+  {
+    auto begin = _offsets[index - 1];
+    auto h = fnv1a (_pool.data () + begin, _offsets[index] - begin);
+    auto i = h & mask;
+    while (slots[i]._index)
+      i = (i + 1) & mask;
+
+    slots[i] = {(std::uint32_t) h, index};
+  }
+
+  _slots.swap (slots);
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_STRINGSET
+#define INCLUDED_STRINGSET
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <Text.h>
+
+// A set of strings, loaded from a file of one per line, for rules that match
+// whole lines or tokens against long lists.  The strings are packed into one
+// pool, and found by open addressing in a table at most half full, so lookup
+// costs one hash and usually one comparison, whatever the size of the list.
+// Unlike std::unordered_set, lookup takes a pointer and length, so a token
+// is looked up where it lies in the line, without a copy.
+class StringSet
+{
+public:
+  void load (const std::string&);
+  void insert (const char*, std::size_t);
+  bool contains (const char*, std::size_t) const;
+  std::size_t size () const;
+  std::uint64_t fingerprint () const;
+
+private:
+  void grow ();
+
+private:
+  // A slot holds the index of a string plus one, zero when empty, and the
+  // low bits of its hash, compared before the string itself.
+  struct Slot
+  {
+    std::uint32_t _hash;
+    std::uint32_t _index;
+  };
+
+  std::string                 _pool        {};
+  std::vector <std::uint32_t> _offsets     {0};
+  std::vector <Slot>          _slots       {};
+  std::uint64_t               _fingerprint {FNV_BASIS};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Summary.h>
+#include <Text.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+////////////////////////////////////////////////////////////////////////////////
+Summary::Summary (
+  std::vector <Rule>& rules,
+  const std::vector <std::string>& sections)
+{
+  std::vector <std::string> names (sections);
+  if (names.size () == 0)
+    names.push_back ("default");
+
+  for (std::size_t s = 0; s < names.size (); ++s)
+  {
+    if (std::find (names.begin (), names.begin () + s, names[s]) != names.begin () + s)
+      continue;
+
+    for (std::size_t r = 0; r < rules.size (); ++r)
+      if (rules[r]._section == names[s])
+      {
+        _rules.push_back (&rules[r]);
+        _numbers.push_back (r + 1);
+      }
+  }
+
+  _counts.resize (_rules.size (), 0);
+  _hit.resize (_rules.size (), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A number of seconds, or of minutes, hours or days with an m, h or d suffix.
+long long Summary::duration (const std::string& value)
+{
+  char* end;
+  auto number = strtoll (value.c_str (), &end, 10);
+  long long unit = 0;
+  if      (! strcmp (end, "") || ! strcmp (end, "s")) unit = 1;
+  else if (! strcmp (end, "m"))                        unit = 60;
+  else if (! strcmp (end, "h"))                        unit = 3600;
+  else if (! strcmp (end, "d"))                        unit = 86400;
+
+  if (end == value.c_str () || unit == 0 || number <= 0)
+    throw std::string ("Cannot parse duration '") + value + "'.";
+
+  return number * unit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Buckets of this many seconds, or 0 for one count over all input.
+void Summary::bucket (long long seconds)
+{
+  _size = seconds;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Summary::csv (bool value)
+{
+  _csv = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts a line, or one segment of a long line, which is first if it begins
+// the line.  A line in a later bucket outputs the current one first.
+void Summary::add (const std::string& line, bool first, std::string& output)
+{
+  if (first)
+  {
+    commit ();
+
+    if (_size && _timestamp.scan (line))
+    {
+      auto epoch = _timestamp.epoch ();
+      auto start = epoch - ((epoch % _size) + _size) % _size;
+      if (! _dated || start != _start)
+      {
+        if (_lines)
+          flush (output);
+
+        _dated = true;
+        _start = start;
+      }
+    }
+
+    _pending = true;
+  }
+
+  for (std::size_t i = 0; i < _rules.size (); ++i)
+    if (! _hit[i] && _rules[i]->hits (_scratch, line))
+      _hit[i] = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// At end of input, outputs what is left.
+void Summary::finish (std::string& output)
+{
+  commit ();
+  if (_lines || ! _size)
+    flush (output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Summary::commit ()
+{
+  if (! _pending)
+    return;
+
+  ++_lines;
+  for (std::size_t i = 0; i < _rules.size (); ++i)
+  {
+    _counts[i] += _hit[i];
+    _hit[i] = 0;
+  }
+
+  _pending = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Summary::flush (std::string& output)
+{
+  if (_csv)
+    rows (output);
+  else
+    table (output);
+
+  _lines = 0;
+  std::fill (_counts.begin (), _counts.end (), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The start of the current bucket, in the form timestamps are written, or
+// nothing before the first timestamp.
+static std::string label (bool dated, long long start)
+{
+  if (! dated)
+    return "";
+
+  time_t seconds = start;
+  struct tm t;
+  gmtime_r (&seconds, &t);
+
+  char stamp[32];
+  strftime (stamp, sizeof (stamp), "%Y-%m-%d %H:%M:%S", &t);
+  return stamp;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Rule Section Action   Pattern Hits
+//      1 default line     "foo"    120
+//      2 default suppress /bar/      3
+//   Lines                         5000
+void Summary::table (std::string& output)
+{
+  std::vector <std::vector <std::string>> cells {{"Rule", "Section", "Action", "Pattern", "Hits"}};
+  for (std::size_t i = 0; i < _rules.size (); ++i)
+    cells.push_back ({std::to_string (_numbers[i]),
+                      _rules[i]->_section,
+                      Rule::name (_rules[i]->_context),
+                      _rules[i]->_pattern,
+                      std::to_string (_counts[i])});
+
+  cells.push_back ({"Lines", "", "", "", std::to_string (_lines)});
+
+  std::vector <std::string::size_type> widths (5, 0);
+  for (auto& row : cells)
+    for (std::size_t c = 0; c < row.size (); ++c)
+      widths[c] = std::max (widths[c], row[c].length ());
+
+  if (_size)
+    output += (_dated ? label (_dated, _start) : "Before the first timestamp") + "\n\n";
+
+  for (std::size_t r = 0; r < cells.size (); ++r)
+  {
+    std::string line;
+    for (std::size_t c = 0; c < 5; ++c)
+    {
+      auto& cell = cells[r][c];
+      auto pad = std::string (widths[c] - cell.length (), ' ');
+      bool right = c == 4 || (c == 0 && r > 0 && r + 1 < cells.size ());
+      line += right ? pad + cell : cell + pad;
+      if (c < 4)
+        line += ' ';
+    }
+
+    line.erase (line.find_last_not_of (' ') + 1);
+    output += line + '\n';
+  }
+
+  if (_size)
+    output += '\n';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// time,lines,rule,section,action,pattern,hits
+void Summary::rows (std::string& output)
+{
+  if (_header)
+  {
+    output += "time,lines,rule,section,action,pattern,hits\n";
+    _header = false;
+  }
+
+  auto time = label (_dated, _start);
+  for (std::size_t i = 0; i < _rules.size (); ++i)
+    output += time + ','
+            + std::to_string (_lines) + ','
+            + std::to_string (_numbers[i]) + ','
+            + csvField (_rules[i]->_section) + ','
+            + csvField (Rule::name (_rules[i]->_context)) + ','
+            + csvField (_rules[i]->_pattern) + ','
+            + std::to_string (_counts[i]) + '\n';
+}
+
+////////////////////////////////////////////////////////////////////////////////
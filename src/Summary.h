@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_SUMMARY
+#define INCLUDED_SUMMARY
+
+#include <string>
+#include <vector>
+#include <Rule.h>
+#include <Timestamp.h>
+
+// Counts the lines hit by each rule of the sections, instead of rendering
+// them.  Only yes/no decisions are needed, so no layers are built, and every
+// rule is asked, as the counts are per rule.  With a bucket size, the counts
+// are kept per bucket of time, by line timestamp, and each bucket is output
+// as soon as a line of a later one arrives.  Output is a table, or CSV.
+class Summary
+{
+public:
+  Summary (std::vector <Rule>&, const std::vector <std::string>&);
+  static long long duration (const std::string&);
+  void bucket (long long);
+  void csv (bool);
+  void add (const std::string&, bool, std::string&);
+  void finish (std::string&);
+
+private:
+  void commit ();
+  void flush (std::string&);
+  void table (std::string&);
+  void rows (std::string&);
+
+private:
+  std::vector <Rule*>         _rules   {};
+  std::vector <std::size_t>   _numbers {};  // From 1, in load order
+  std::vector <unsigned long> _counts  {};
+  std::vector <char>          _hit     {};  // For the current line
+  Rule::Scratch               _scratch {};
+  unsigned long               _lines   {0};
+  bool                        _pending {false};
+  long long                   _size    {0};
+  bool                        _dated   {false};
+  long long                   _start   {0};
+  bool                        _csv     {false};
+  bool                        _header  {true};
+  Timestamp                   _timestamp {};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
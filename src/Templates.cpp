@@ -0,0 +1,494 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Templates.h>
+#include <Text.h>
+#include <algorithm>
+#include <cstdio>
+
+static const std::size_t   MIN_COUNTERS     = 1000;
+static const std::size_t   COUNTERS_PER_ROW = 10;    // Per template shown
+static const std::size_t   MAX_TEMPLATE     = 200;   // Bytes kept of a template
+
+////////////////////////////////////////////////////////////////////////////////
+static inline bool isHex (char c)
+{
+  return isDigit (c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static inline bool isWord (char c)
+{
+  return isHex (c) || (c >= 'g' && c <= 'z') || (c >= 'G' && c <= 'Z') || c == '_';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The length of a UUID at i, 8-4-4-4-12 hex digits, or 0.
+static std::size_t uuid (const char* s, std::size_t i, std::size_t n)
+{
+  if (n - i < 36 || (n - i > 36 && isWord (s[i + 36])))
+    return 0;
+
+  for (std::size_t j = 0; j < 36; ++j)
+  {
+    bool dash = j == 8 || j == 13 || j == 18 || j == 23;
+    if (dash ? s[i + j] != '-' : ! isHex (s[i + j]))
+      return 0;
+  }
+
+  return 36;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The length of a dotted IPv4 address at i, or 0.
+static std::size_t ipv4 (const char* s, std::size_t i, std::size_t n)
+{
+  auto j = i;
+  for (int part = 0; part < 4; ++part)
+  {
+    if (part && (j >= n || s[j++] != '.'))
+      return 0;
+
+    auto digits = j;
+    while (j < n && j - digits < 3 && isDigit (s[j]))
+      ++j;
+
+    if (j == digits)
+      return 0;
+  }
+
+  if (j < n && (isWord (s[j]) || (s[j] == '.' && j + 1 < n && isDigit (s[j + 1]))))
+    return 0;
+
+  return j - i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The length of a hex ID at i, as 0x<hex>, or as eight or more hex digits
+// mixing digits and letters, or 0.
+static std::size_t hexId (const char* s, std::size_t i, std::size_t n)
+{
+  auto j = i;
+  if (n - i > 2 && s[i] == '0' && (s[i + 1] == 'x' || s[i + 1] == 'X') && isHex (s[i + 2]))
+    j += 2;
+
+  bool digit = false;
+  bool letter = false;
+  auto start = j;
+  for (; j < n && isHex (s[j]); ++j)
+  {
+    if (isDigit (s[j]))
+      digit = true;
+    else
+      letter = true;
+  }
+
+  if (j < n && isWord (s[j]))
+    return 0;
+
+  if (start > i || (j - start >= 8 && digit && letter))
+    return j - i;
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Keeps ten counters for each template shown, and at least a thousand.
+Templates::Templates (std::size_t k)
+: _k (k)
+{
+  auto counters = std::max (k * COUNTERS_PER_ROW, MIN_COUNTERS);
+  _counters.resize (counters);
+  for (auto& counter : _counters)
+    counter._template.reserve (MAX_TEMPLATE);
+
+  _position.resize (counters);
+
+  std::size_t slots = 1;
+  while (slots < 2 * counters)
+    slots *= 2;
+
+  _slots.assign (slots, 0);
+  _shown = std::chrono::steady_clock::now ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Outputs the table every so many seconds, replacing the last one on the
+// terminal, or 0 for only at the end.
+void Templates::refresh (double seconds)
+{
+  _refresh = std::chrono::duration_cast <std::chrono::steady_clock::duration> (
+               std::chrono::duration <double> (seconds));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Templates::csv (bool value)
+{
+  _csv = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts a line by its template.  Later segments of a long line are not
+// counted again.
+void Templates::add (const std::string& line, bool first, std::string& output)
+{
+  if (! first)
+    return;
+
+  normalize (line, _template);
+  count (_template);
+  ++_lines;
+
+  // The clock is read for every line, so that a slow stream is shown as
+  // often as a fast one.
+  if (_refresh.count () &&
+      std::chrono::steady_clock::now () - _shown >= _refresh)
+  {
+    output += "\x1b[H\x1b[2J";
+    table (output);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Templates::finish (std::string& output)
+{
+  if (_csv)
+    rows (output);
+  else
+  {
+    if (_refresh.count ())
+      output += "\x1b[H\x1b[2J";
+
+    table (output);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Masks the variable parts of a line, in one pass: IPv4 addresses, UUIDs and
+// hex IDs that begin a word, and any run of digits, with a fraction.  Only
+// the first MAX_TEMPLATE bytes are kept.
+void Templates::normalize (const std::string& line, std::string& output)
+{
+  output.clear ();
+
+  // Literal text is copied in runs, from copied up to i.
+  auto s = line.data ();
+  auto n = line.length ();
+  std::size_t i = 0;
+  std::size_t copied = 0;
+  auto mask = [&] (const char* token, std::size_t length)
+  {
+    output.append (s + copied, i - copied);
+    output += token;
+    i += length;
+    copied = i;
+  };
+
+  while (i < n && output.length () + (i - copied) < MAX_TEMPLATE)
+  {
+    if (isHex (s[i]) && (i == 0 || ! isWord (s[i - 1])))
+    {
+      std::size_t length;
+      if ((length = ipv4 (s, i, n)))
+      {
+        mask ("<ip>", length);
+        continue;
+      }
+
+      if ((length = uuid (s, i, n)))
+      {
+        mask ("<uuid>", length);
+        continue;
+      }
+
+      if ((length = hexId (s, i, n)))
+      {
+        mask ("<hex>", length);
+        continue;
+      }
+    }
+
+    if (isDigit (s[i]))
+    {
+      auto j = i;
+      while (j < n && isDigit (s[j]))
+        ++j;
+
+      if (j + 1 < n && s[j] == '.' && isDigit (s[j + 1]))
+        for (++j; j < n && isDigit (s[j]); )
+          ++j;
+
+      mask ("<num>", j - i);
+      continue;
+    }
+
+    ++i;
+  }
+
+  output.append (s + copied, i - copied);
+  if (output.length () > MAX_TEMPLATE)
+    output.resize (MAX_TEMPLATE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts a template.  One not counted yet takes an unused counter, or else
+// replaces the template with the lowest count.
+void Templates::count (const std::string& name)
+{
+  auto h = fnv1a (name);
+  auto mask = _slots.size () - 1;
+  for (auto i = h & mask; _slots[i]; i = (i + 1) & mask)
+  {
+    auto& counter = _counters[_slots[i] - 1];
+    if (counter._hash == h && counter._template == name)
+    {
+      ++counter._count;
+      down (_position[_slots[i] - 1]);
+      return;
+    }
+  }
+
+  std::size_t index;
+  unsigned long floor = 0;
+  if (_used < _counters.size ())
+  {
+    index = _used++;
+    _heap.push_back (index);
+    _position[index] = _heap.size () - 1;
+  }
+  else
+  {
+    index = _heap[0];
+    floor = _counters[index]._count;
+    erase (index);
+  }
+
+  auto& counter = _counters[index];
+  counter._template.assign (name);
+  counter._hash = h;
+  counter._count = floor + 1;
+  counter._error = floor;
+  counter._last = floor;
+  _slots[slot (h)] = index + 1;
+
+  if (floor)
+    down (_position[index]);
+  else
+    up (_position[index]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t Templates::size () const
+{
+  return _used;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long Templates::count (std::size_t index) const
+{
+  return _counters[index]._count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// How much the count may exceed the true count.
+unsigned long Templates::error (std::size_t index) const
+{
+  return _counters[index]._error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string& Templates::name (std::size_t index) const
+{
+  return _counters[index]._template;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The counters of the k most frequent templates, most frequent first.
+std::vector <std::size_t> Templates::top () const
+{
+  std::vector <std::size_t> indexes (_used);
+  for (std::size_t i = 0; i < _used; ++i)
+    indexes[i] = i;
+
+  auto k = std::min (_k, _used);
+  std::partial_sort (indexes.begin (), indexes.begin () + k, indexes.end (),
+                     [this] (std::size_t a, std::size_t b)
+                     {
+                       if (_counters[a]._count != _counters[b]._count)
+                         return _counters[a]._count > _counters[b]._count;
+
+                       return _counters[a]._template < _counters[b]._template;
+                     });
+
+  indexes.resize (k);
+  return indexes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Templates::up (std::size_t position)
+{
+  while (position > 0)
+  {
+    auto parent = (position - 1) / 2;
+    if (_counters[_heap[parent]]._count <= _counters[_heap[position]]._count)
+      break;
+
+    swap (parent, position);
+    position = parent;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Templates::down (std::size_t position)
+{
+  while (true)
+  {
+    auto lowest = position;
+    for (auto child : {2 * position + 1, 2 * position + 2})
+      if (child < _heap.size () &&
+          _counters[_heap[child]]._count < _counters[_heap[lowest]]._count)
+        lowest = child;
+
+    if (lowest == position)
+      break;
+
+    swap (lowest, position);
+    position = lowest;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Templates::swap (std::size_t a, std::size_t b)
+{
+  std::swap (_heap[a], _heap[b]);
+  _position[_heap[a]] = a;
+  _position[_heap[b]] = b;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Removes a counter from the hash slots.  Later entries of its probe run are
+// shifted back, so that lookups need no tombstones.
+void Templates::erase (std::size_t index)
+{
+  auto mask = _slots.size () - 1;
+  auto i = _counters[index]._hash & mask;
+  while (_slots[i] != index + 1)
+    i = (i + 1) & mask;
+
+  for (auto j = (i + 1) & mask; _slots[j]; j = (j + 1) & mask)
+  {
+    auto home = _counters[_slots[j] - 1]._hash & mask;
+
+    // Move the entry at j back to i, unless its home lies cyclically in
+    // (i, j], where it would no longer be found.
+    bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (! stays)
+    {
+      _slots[i] = _slots[j];
+      i = j;
+    }
+  }
+
+  _slots[i] = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The free slot for a hash.
+std::size_t Templates::slot (std::uint64_t h) const
+{
+  auto mask = _slots.size () - 1;
+  auto i = h & mask;
+  while (_slots[i])
+    i = (i + 1) & mask;
+
+  return i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Count Error Rate/s Template
+//    1200     0  400.0 <num>-<num>-<num> GET /index.html
+//   Lines 5000
+//
+// The rate is of the lines counted since the last table.
+void Templates::table (std::string& output)
+{
+  auto now = std::chrono::steady_clock::now ();
+  auto seconds = std::chrono::duration <double> (now - _shown).count ();
+
+  std::vector <std::vector <std::string>> cells {{"Count", "Error", "Rate/s", "Template"}};
+  for (auto index : top ())
+  {
+    auto& counter = _counters[index];
+    char rate[32];
+    snprintf (rate, sizeof (rate), "%.1f", seconds > 0 ? (counter._count - counter._last) / seconds : 0.0);
+    cells.push_back ({std::to_string (counter._count),
+                      std::to_string (counter._error),
+                      rate,
+                      counter._template});
+  }
+
+  for (std::size_t i = 0; i < _used; ++i)
+    _counters[i]._last = _counters[i]._count;
+
+  _shown = now;
+
+  std::vector <std::string::size_type> widths (4, 0);
+  for (auto& row : cells)
+    for (std::size_t c = 0; c < 3; ++c)
+      widths[c] = std::max (widths[c], row[c].length ());
+
+  for (auto& row : cells)
+  {
+    std::string line;
+    for (std::size_t c = 0; c < 3; ++c)
+      line += std::string (widths[c] - row[c].length (), ' ') + row[c] + ' ';
+
+    line += row[3];
+    line.erase (line.find_last_not_of (' ') + 1);
+    output += line + '\n';
+  }
+
+  output += "Lines " + std::to_string (_lines) + '\n';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// count,error,template
+void Templates::rows (std::string& output)
+{
+  if (_header)
+  {
+    output += "count,error,template\n";
+    _header = false;
+  }
+
+  for (auto index : top ())
+    output += std::to_string (_counters[index]._count) + ','
+            + std::to_string (_counters[index]._error) + ','
+            + csvField (_counters[index]._template) + '\n';
+}
+
+////////////////////////////////////////////////////////////////////////////////
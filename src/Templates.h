@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_TEMPLATES
+#define INCLUDED_TEMPLATES
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// Finds the most frequent message templates, which are lines with numbers,
+// hex IDs, UUIDs and IPv4 addresses masked.  Templates are counted with the
+// Space-Saving algorithm, in a fixed number of counters: a template that is
+// not counted yet takes over the counter with the lowest count, and inherits
+// that count as its possible error.  Any template seen more often than once
+// per counter's share of the lines is guaranteed to be counted, and memory
+// does not grow with the number of distinct lines.
+class Templates
+{
+public:
+  explicit Templates (std::size_t);
+  void refresh (double);
+  void csv (bool);
+  void add (const std::string&, bool, std::string&);
+  void finish (std::string&);
+  void count (const std::string&);
+  std::size_t size () const;
+  unsigned long count (std::size_t) const;
+  unsigned long error (std::size_t) const;
+  const std::string& name (std::size_t) const;
+  std::vector <std::size_t> top () const;
+  static void normalize (const std::string&, std::string&);
+
+private:
+  struct Counter
+  {
+    std::string   _template;
+    std::uint64_t _hash;
+    unsigned long _count;
+    unsigned long _error;
+    unsigned long _last;   // Count at the last table
+  };
+
+  void up (std::size_t);
+  void down (std::size_t);
+  void swap (std::size_t, std::size_t);
+  void erase (std::size_t);
+  std::size_t slot (std::uint64_t) const;
+  void table (std::string&);
+  void rows (std::string&);
+
+private:
+  std::size_t                 _k        {10};
+  std::vector <Counter>       _counters {};
+  std::size_t                 _used     {0};
+  std::vector <std::uint32_t> _heap     {};  // Counters, lowest count first
+  std::vector <std::uint32_t> _position {};  // Of each counter in _heap
+  std::vector <std::uint32_t> _slots    {};  // Counter + 1, by hash, or 0
+  std::string                 _template {};
+  unsigned long               _lines    {0};
+  bool                        _csv      {false};
+  bool                        _header   {true};
+  std::chrono::steady_clock::duration   _refresh {};
+  std::chrono::steady_clock::time_point _shown   {};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
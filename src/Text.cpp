@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Text.h>
+
+////////////////////////////////////////////////////////////////////////////////
+std::uint64_t fnv1a (const char* data, std::size_t length, std::uint64_t hash)
+{
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    hash ^= (unsigned char) data[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::uint64_t fnv1a (const std::string& text, std::uint64_t hash)
+{
+  return fnv1a (text.data (), text.length (), hash);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Quotes a CSV field, if it needs it.
+std::string csvField (const std::string& value)
+{
+  if (value.find_first_of (",\"\n") == std::string::npos)
+    return value;
+
+  std::string quoted = "\"";
+  for (auto c : value)
+  {
+    if (c == '"')
+      quoted += '"';
+
+    quoted += c;
+  }
+
+  return quoted + '"';
+}
+
+////////////////////////////////////////////////////////////////////////////////
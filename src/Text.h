@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_TEXT
+#define INCLUDED_TEXT
+
+#include <string>
+#include <cstdint>
+
+// Small text helpers shared by the modules that scan, hash and write text.
+const std::uint64_t FNV_BASIS = 14695981039346656037ULL;
+
+inline bool isDigit (char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// FNV-1a, continuing from an earlier hash, so that several texts hash as one.
+std::uint64_t fnv1a (const char*, std::size_t, std::uint64_t = FNV_BASIS);
+std::uint64_t fnv1a (const std::string&, std::uint64_t = FNV_BASIS);
+std::string csvField (const std::string&);
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <TimeRange.h>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+// Accepts any timestamp format that is recognized in logs, as the whole
+// argument, or a date alone, meaning midnight.
+long long TimeRange::parse (const std::string& value)
+{
+  Timestamp timestamp;
+  for (auto& candidate : {value, value + "T00:00"})
+    if (timestamp.scan (candidate) &&
+        timestamp._offset == 0     &&
+        timestamp._length == candidate.length ())
+      return timestamp.epoch ();
+
+  throw std::string ("Cannot parse time '") + value + "'.";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TimeRange::since (long long value)
+{
+  _since = value;
+  _bySince = true;
+  _inside = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TimeRange::until (long long value)
+{
+  _until = value;
+  _byUntil = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool TimeRange::active () const
+{
+  return _bySince || _byUntil;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The cheap check made before any rule is evaluated: a timestamp is usually
+// found within the first few bytes of a line.  Lines before the first
+// timestamp are admitted only if there is no --since.
+bool TimeRange::admit (const std::string& line)
+{
+  if (_timestamp.scan (line))
+  {
+    auto epoch = _timestamp.epoch ();
+    _inside = (! _bySince || epoch >= _since) &&
+              (! _byUntil || epoch <  _until);
+    _past = _byUntil && epoch >= _until;
+  }
+
+  return _inside;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// True once a line at or after --until has been seen.
+bool TimeRange::past () const
+{
+  return _past;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Finds the byte range [begin, end) of a sorted, mapped file that holds the
+// window, by binary search, without reading the lines outside it.
+void TimeRange::locate (
+  const char* data,
+  std::size_t size,
+  std::size_t& begin,
+  std::size_t& end)
+{
+  begin = _bySince ? first (data, size, _since) : 0;
+  end   = _byUntil ? first (data, size, _until) : size;
+  if (end < begin)
+    end = begin;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The start of the first timestamped line at or after target.  The time of
+// the first timestamped line starting at or after a position grows with the
+// position, so the smallest position where it reaches the target is found by
+// bisection, and each probe reads only up to the next timestamped line.
+std::size_t TimeRange::first (const char* data, std::size_t size, long long target)
+{
+  std::size_t low = 0;
+  std::size_t high = size;
+  while (low < high)
+  {
+    auto middle = low + (high - low) / 2;
+    std::size_t start = middle;
+    long long epoch;
+    if (! stamped (data, size, start, epoch) || epoch >= target)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+
+  std::size_t start = low;
+  long long epoch;
+  return stamped (data, size, start, epoch) ? start : size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Moves start to the first line beginning at or after it that has a
+// timestamp, and gets that time.
+bool TimeRange::stamped (
+  const char* data,
+  std::size_t size,
+  std::size_t& start,
+  long long& epoch)
+{
+  if (start > 0 && data[start - 1] != '\n')
+  {
+    auto eol = (const char*) memchr (data + start, '\n', size - start);
+    start = eol ? eol - data + 1 : size;
+  }
+
+  while (start < size)
+  {
+    auto eol = (const char*) memchr (data + start, '\n', size - start);
+    auto length = (eol ? eol - data : size) - start;
+    if (_timestamp.scan (data + start, length))
+    {
+      epoch = _timestamp.epoch ();
+      return true;
+    }
+
+    start += length + 1;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_TIMERANGE
+#define INCLUDED_TIMERANGE
+
+#include <string>
+#include <Timestamp.h>
+
+// The window of time given by --since and --until.  A line is admitted if its
+// timestamp lies in [since, until), and a line without a timestamp, such as
+// the continuation of a stack trace, goes with the line before it.  Input is
+// assumed to be in time order, so a sorted file can be searched for the
+// window, and reading can stop once the window has passed.
+class TimeRange
+{
+public:
+  static long long parse (const std::string&);
+  void since (long long);
+  void until (long long);
+  bool active () const;
+  bool admit (const std::string&);
+  bool past () const;
+  void locate (const char*, std::size_t, std::size_t&, std::size_t&);
+
+private:
+  std::size_t first (const char*, std::size_t, long long);
+  bool stamped (const char*, std::size_t, std::size_t&, long long&);
+
+private:
+  long long _since    {0};
+  long long _until    {0};
+  bool      _bySince  {false};
+  bool      _byUntil  {false};
+  bool      _inside   {true};
+  bool      _past     {false};
+  Timestamp _timestamp {};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Timestamp.h>
+#include <Text.h>
+#include <cstring>
+#include <ctime>
+
+static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+////////////////////////////////////////////////////////////////////////////////
+static inline bool isAlnum (char c)
+{
+  return isDigit (c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads exactly count digits.
+static bool digits (const char*& p, const char* end, int count, int& value)
+{
+  if (end - p < count)
+    return false;
+
+  value = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    if (! isDigit (p[i]))
+      return false;
+
+    value = value * 10 + (p[i] - '0');
+  }
+
+  p += count;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads a three letter month name, as in "Jun".
+static bool month (const char*& p, const char* end, int& value)
+{
+  if (end - p < 3)
+    return false;
+
+  for (int i = 0; i < 12; ++i)
+    if (! strncmp (p, months + i * 3, 3))
+    {
+      value = i + 1;
+      p += 3;
+      return true;
+    }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Syslog timestamps have no year, so the current one is assumed.
+static int currentYear ()
+{
+  static const int year = []
+  {
+    auto now = time (nullptr);
+    struct tm t;
+    localtime_r (&now, &t);
+    return t.tm_year + 1900;
+  } ();
+
+  return year;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Days since 1970-01-01 of a proleptic Gregorian date.
+static long long daysFromCivil (int year, int month, int day)
+{
+  year -= month <= 2;
+  long long era = (year >= 0 ? year : year - 399) / 400;
+  long long yoe = year - era * 400;
+  long long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Timestamp::scan (const std::string& line)
+{
+  return scan (line.data (), line.length ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// One pass over the line.  Only a digit or a capital letter at the start of a
+// word can begin a timestamp, and each format is rejected within a few bytes.
+bool Timestamp::scan (const char* data, std::string::size_type length)
+{
+  _start = data;
+  auto end = data + length;
+  for (auto p = data; p < end; ++p)
+  {
+    if (p > data && isAlnum (p[-1]))
+      continue;
+
+    if (isDigit (*p))
+    {
+      if (iso (p, end) || common (p, end))
+        return true;
+    }
+    else if (*p >= 'A' && *p <= 'S')
+    {
+      if (syslog (p, end))
+        return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Seconds since the epoch.  A timestamp without a zone is taken as UTC, so
+// that such timestamps compare as written.
+long long Timestamp::epoch () const
+{
+  return daysFromCivil (_year, _month, _day) * 86400LL
+       + _hour * 3600 + _minute * 60 + _second
+       - (_zoned ? _zone : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 2017-06-25T14:03:11.123+02:00, 2017-06-25 14:03:11, 2017/06/25 14:03:11
+bool Timestamp::iso (const char* p, const char* end)
+{
+  auto start = p;
+  if (! digits (p, end, 4, _year) || p == end || (*p != '-' && *p != '/'))
+    return false;
+
+  auto separator = *p++;
+  if (! digits (p, end, 2, _month) || p == end || *p++ != separator ||
+      ! digits (p, end, 2, _day)   || p == end || (*p != 'T' && *p != ' '))
+    return false;
+
+  p = clock (p + 1, end, false);
+  if (! p)
+    return false;
+
+  p = zone (p, end, true);
+  _offset = start - _start;
+  _length = p - start;
+  return _month >= 1 && _month <= 12 && _day >= 1 && _day <= 31;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 25/Jun/2017:14:03:11 +0200
+bool Timestamp::common (const char* p, const char* end)
+{
+  auto start = p;
+  if (! digits (p, end, 2, _day)  || p == end || *p++ != '/' ||
+      ! month (p, end, _month)    || p == end || *p++ != '/' ||
+      ! digits (p, end, 4, _year) || p == end || *p++ != ':')
+    return false;
+
+  p = clock (p, end, true);
+  if (! p)
+    return false;
+
+  _zoned = false;
+  _zone = 0;
+  if (p < end && *p == ' ')
+  {
+    auto zoned = zone (p + 1, end, false);
+    if (zoned != p + 1)
+      p = zoned;
+  }
+
+  _offset = start - _start;
+  _length = p - start;
+  return _day >= 1 && _day <= 31;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Jun 25 14:03:11, or Jun  5 14:03:11
+bool Timestamp::syslog (const char* p, const char* end)
+{
+  auto start = p;
+  if (! month (p, end, _month) || p == end || *p++ != ' ' || p == end)
+    return false;
+
+  if (*p == ' ')
+    ++p;
+
+  if (! digits (p, end, 2, _day) && ! digits (p, end, 1, _day))
+    return false;
+
+  if (p == end || *p++ != ' ')
+    return false;
+
+  p = clock (p, end, true);
+  if (! p)
+    return false;
+
+  _year = currentYear ();
+  _zoned = false;
+  _offset = start - _start;
+  _length = p - start;
+  return _day >= 1 && _day <= 31;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// HH:MM[:SS[.fraction]], or HH:MM:SS when seconds are required.  Returns the
+// end of the time of day, or nullptr.
+const char* Timestamp::clock (const char* p, const char* end, bool seconds)
+{
+  auto start = p;
+  if (! digits (p, end, 2, _hour)   || p == end || *p++ != ':' ||
+      ! digits (p, end, 2, _minute) || _hour > 23 || _minute > 59)
+    return nullptr;
+
+  _second = 0;
+  _nanosecond = 0;
+  if (p < end && *p == ':')
+  {
+    ++p;
+    if (! digits (p, end, 2, _second) || _second > 60)
+      return nullptr;
+
+    if (p + 1 < end && (*p == '.' || *p == ',') && isDigit (p[1]))
+    {
+      ++p;
+      long scale = 100000000;
+      for (; p < end && isDigit (*p); ++p, scale /= 10)
+        _nanosecond += (*p - '0') * scale;
+    }
+  }
+  else if (seconds)
+    return nullptr;
+
+  _clock = start - _start;
+  _clockLength = p - start;
+  return p;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Z, +02:00 or -0700, the colon being accepted only where ISO 8601 allows it.
+// Returns the end of the zone, which is p if there is none.
+const char* Timestamp::zone (const char* p, const char* end, bool colon)
+{
+  _zoned = false;
+  _zone = 0;
+  if (p < end && *p == 'Z')
+  {
+    _zoned = true;
+    return p + 1;
+  }
+
+  if (p < end && (*p == '+' || *p == '-'))
+  {
+    auto sign = *p == '-' ? -1 : 1;
+    auto q = p + 1;
+    int hours, minutes;
+    if (digits (q, end, 2, hours))
+    {
+      if (colon && q < end && *q == ':')
+        ++q;
+
+      if (digits (q, end, 2, minutes) && hours <= 14 && minutes <= 59)
+      {
+        _zoned = true;
+        _zone = sign * (hours * 3600 + minutes * 60);
+        return q;
+      }
+    }
+  }
+
+  return p;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_TIMESTAMP
+#define INCLUDED_TIMESTAMP
+
+#include <string>
+
+// Finds the first timestamp in a log line, without regular expressions, and
+// records where it is, where its time of day is, and what it says.  These
+// formats are recognized:
+//
+//   ISO 8601    2017-06-25T14:03:11.123+02:00, or with a space instead of T
+//   nginx       2017/06/25 14:03:11
+//   syslog      Jun 25 14:03:11, the year being the current one
+//   Apache      25/Jun/2017:14:03:11 +0200
+//
+class Timestamp
+{
+public:
+  bool scan (const std::string&);
+  bool scan (const char*, std::string::size_type);
+  long long epoch () const;
+
+private:
+  bool iso (const char*, const char*);
+  bool common (const char*, const char*);
+  bool syslog (const char*, const char*);
+  const char* clock (const char*, const char*, bool);
+  const char* zone (const char*, const char*, bool);
+
+public:
+  std::string::size_type _offset      {0};  // The whole timestamp
+  std::string::size_type _length      {0};
+  std::string::size_type _clock       {0};  // The time of day, within it
+  std::string::size_type _clockLength {0};
+  int                    _year        {0};
+  int                    _month       {0};  // 1-12
+  int                    _day         {0};
+  int                    _hour        {0};
+  int                    _minute      {0};
+  int                    _second      {0};
+  long                   _nanosecond  {0};
+  bool                   _zoned       {false};
+  int                    _zone        {0};  // Seconds east of UTC
+
+private:
+  const char*            _start       {nullptr};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
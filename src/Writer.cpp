@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Writer.h>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <unistd.h>
+
+// Output is written once this much is collected, or this many pieces.
+static const std::size_t BLOCK_SIZE = 1 << 16;
+static const std::size_t PIECES     = IOV_MAX < 1024 ? IOV_MAX : 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+Writer::Writer (int fd)
+: _fd (fd)
+{
+  _pieces.reserve (PIECES);
+  _vectors.reserve (PIECES);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Errors can no longer be reported here, so flush explicitly to see them.
+Writer::~Writer ()
+{
+  try
+  {
+    flush ();
+  }
+
+  catch (...)
+  {
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Writer::add (const std::string& text)
+{
+  if (text.length () == 0)
+    return;
+
+  if (_pieces.size () && ! _pieces.back ()._base)
+    _pieces.back ()._length += text.length ();
+  else
+    _pieces.push_back ({nullptr, _buffer.length (), text.length ()});
+
+  _buffer += text;
+  _total += text.length ();
+  if (_total >= BLOCK_SIZE || _pieces.size () == PIECES)
+    flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Writer::borrow (const char* data, std::size_t length)
+{
+  if (length == 0)
+    return;
+
+  if (_pieces.size () &&
+      _pieces.back ()._base &&
+      _pieces.back ()._base + _pieces.back ()._length == data)
+    _pieces.back ()._length += length;
+  else
+    _pieces.push_back ({data, 0, length});
+
+  _total += length;
+  if (_total >= BLOCK_SIZE || _pieces.size () == PIECES)
+    flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Writer::flush ()
+{
+  _vectors.clear ();
+  for (auto& piece : _pieces)
+  {
+    auto base = piece._base ? piece._base : _buffer.data () + piece._offset;
+    _vectors.push_back ({(void*) base, piece._length});
+  }
+
+  _pieces.clear ();
+  _total = 0;
+
+  // A short write leaves the rest of the current vector, and those after it.
+  auto vector = _vectors.data ();
+  auto count = (int) _vectors.size ();
+  while (count)
+  {
+    auto written = writev (_fd, vector, count);
+    if (written == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      _buffer.clear ();
+      throw std::string ("Write error: ") + strerror (errno);
+    }
+
+    while (count && (std::size_t) written >= vector->iov_len)
+    {
+      written -= vector->iov_len;
+      ++vector;
+      --count;
+    }
+
+    if (count)
+    {
+      vector->iov_base = (char*) vector->iov_base + written;
+      vector->iov_len -= written;
+    }
+  }
+
+  _buffer.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
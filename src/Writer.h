@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_WRITER
+#define INCLUDED_WRITER
+
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+// Collects output for a file descriptor, and writes it with one writev.  Bytes
+// are either copied in, or borrowed, which means they are written from where
+// they are, and must stay there until the next flush.  Borrowed bytes that
+// follow each other in memory are written as one piece, so that a run of
+// lines passed through from the input buffer costs a single iovec.
+class Writer
+{
+public:
+  explicit Writer (int);
+  Writer (const Writer&) = delete;
+  Writer& operator= (const Writer&) = delete;
+  ~Writer ();
+
+  void add (const std::string&);
+  void borrow (const char*, std::size_t);
+  void flush ();
+
+private:
+  // A copied piece has no base, and its offset is into _buffer, which may
+  // move as it grows.
+  struct Piece
+  {
+    const char* _base;
+    std::size_t _offset;
+    std::size_t _length;
+  };
+
+  int                         _fd      {-1};
+  std::string                 _buffer  {};
+  std::vector <Piece>         _pieces  {};
+  std::vector <struct iovec>  _vectors {};
+  std::size_t                 _total   {0};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
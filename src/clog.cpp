@@ -25,7 +25,17 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <cmake.h>
-#include <Rule.h>
+#include <Filter.h>
+#include <Histogram.h>
+#include <Index.h>
+#include <Input.h>
+#include <Pager.h>
+#include <Recording.h>
+#include <Sink.h>
+#include <Writer.h>
+#include <Summary.h>
+#include <Templates.h>
+#include <TimeRange.h>
 // If <iostream> is included, put it after <stdio.h>, because it includes
 // <stdio.h>, and therefore would ignore the _WITH_GETLINE.
 #ifdef FREEBSD
@@ -33,34 +43,156 @@
 #endif
 #include <cstdio>
 #include <iostream>
-#include <iomanip>
 #include <fstream>
 #include <vector>
+#include <memory>
 #include <string>
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 #include <sys/types.h>
 #include <pwd.h>
 #include <ctime>
+#include <chrono>
+#include <csignal>
+#include <atomic>
 #include <shared.h>
 
 extern bool loadRules (const std::string&, std::vector <Rule>&);
+extern std::string defaultSocket ();
+extern int runClient (const std::string&, const std::vector <std::string>&);
+extern int runDaemon (std::vector <Rule>&, const std::string&,
+                      std::string::size_type, bool);
+extern int runFollow (std::vector <Rule>&, const std::vector <std::string>&,
+                      const std::vector <std::string>&, bool, bool,
+                      std::string::size_type, bool, int);
+extern int runReplay (const std::string&, double, const std::vector <std::string>&);
+
+// Time from the arrival of each line to the handover of its output, and bytes
+// read ahead of the filter, now and at most, for --stats.
+static Histogram latency;
+static std::atomic <std::size_t> queued {0};
+static std::atomic <std::size_t> queueHigh {0};
+static std::size_t budget = 16 << 20;
+
+////////////////////////////////////////////////////////////////////////////////
+static void reportLatency (int)
+{
+  char buffer[512] = "clog: ";
+  auto size = sizeof (buffer);
+  auto length = latency.format (buffer + 6, size - 6) + 6;
+  length = Histogram::append (buffer, size, length, "clog: queued ");
+  length = Histogram::append (buffer, size, length, queued / 1024);
+  length = Histogram::append (buffer, size, length, "KiB, high ");
+  length = Histogram::append (buffer, size, length, queueHigh / 1024);
+  length = Histogram::append (buffer, size, length, "KiB, budget ");
+  length = Histogram::append (buffer, size, length, budget / 1024);
+  length = Histogram::append (buffer, size, length, "KiB\n");
+  auto written = write (STDERR_FILENO, buffer, length);
+  (void) written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A number of bytes, optionally with suffix K, M or G.
+static std::size_t parseSize (const std::string& text)
+{
+  char* end;
+  auto value = strtoull (text.c_str (), &end, 10);
+  std::string suffix = end;
+  if (text == "" || end == text.c_str ())
+    throw std::string ("Cannot parse size '") + text + "'.";
+
+  if      (suffix == "")  return value;
+  else if (suffix == "K") return value << 10;
+  else if (suffix == "M") return value << 20;
+  else if (suffix == "G") return value << 30;
+
+  throw std::string ("Cannot parse size '") + text + "'.";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static int parseCount (const std::string& text)
+{
+  char* end;
+  auto value = strtol (text.c_str (), &end, 10);
+  if (text == "" || *end || value < 0 || value > 1000000)
+    throw std::string ("Cannot parse count '") + text + "'.";
+
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A replay speed, as a factor of the recorded pace, or 0 for maximum speed.
+static double parseSpeed (const std::string& text)
+{
+  char* end;
+  auto value = strtod (text.c_str (), &end);
+  if (text == "" || *end || ! (value >= 0))
+    throw std::string ("Cannot parse speed '") + text + "'.";
+
+  return value;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
-// Applies all the rules in all the sections specified.
-// Note that processing does not stop after the first rule match, it keeps going.
-void applyRules (
-  Composite& composite,
-  bool& blanks,
+// Rules are numbered from 1, in the order they are read.
+static std::vector <std::size_t> ruleIndexes (
+  const std::vector <std::string>& numbers,
+  const std::vector <Rule>& rules)
+{
+  std::vector <std::size_t> indexes;
+  for (auto& number : numbers)
+  {
+    char* end;
+    auto value = strtoul (number.c_str (), &end, 10);
+    if (number == "" || *end || value < 1 || value > rules.size ())
+      throw std::string ("There is no rule ") + number + '.';
+
+    indexes.push_back (value - 1);
+  }
+
+  return indexes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// <mode>:<file>, where mode is ansi, plain or rules=<n,...>.
+static Sink* createSink (const std::string& spec, const std::vector <Rule>& rules)
+{
+  auto colon = spec.find (':');
+  if (colon != std::string::npos && colon + 1 < spec.length ())
+  {
+    auto mode = spec.substr (0, colon);
+    auto path = spec.substr (colon + 1);
+    if (mode == "ansi")
+      return new Sink (Sink::Mode::ansi, path, {});
+
+    if (mode == "plain")
+      return new Sink (Sink::Mode::plain, path, {});
+
+    if (mode.compare (0, 6, "rules=") == 0)
+      return new Sink (Sink::Mode::rules, path, ruleIndexes (split (mode.substr (6), ','), rules));
+  }
+
+  throw std::string ("Cannot parse sink '") + spec + "'.";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// True if any of the selected rules hits the line.
+static bool selected (
   std::vector <Rule>& rules,
-  const std::vector <std::string>& sections,
+  const std::vector <std::size_t>& indexes,
   const std::string& line)
 {
-  composite.add (line, 0, {0});
+  static Layers layers;
+  static Rule::Scratch scratch;
+  for (auto i : indexes)
+  {
+    bool blanks = false;
+    layers.clear ();
+    if (rules[i].apply (scratch, layers, blanks, line))
+      return true;
+  }
 
-  for (const auto& section : sections)
-    for (auto& rule : rules)
-      rule.apply (composite, blanks, section, line);
+  return false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -81,8 +213,30 @@ int main (int argc, char** argv)
 
     // Process arguments.
     std::vector <std::string> sections;
+    std::vector <std::string> forward;
     bool prepend_date = false;
     bool prepend_time = false;
+    bool daemon = false;
+    bool client = false;
+    std::string socket = defaultSocket ();
+    std::vector <std::string> follow;
+    std::vector <std::string> inputs;
+    std::string::size_type max_line = 1 << 20;
+    bool truncate = false;
+    TimeRange range;
+    std::vector <std::string> only;
+    bool build_index = false;
+    bool summarize = false;
+    long long bucket = 0;
+    bool csv = false;
+    bool stats = false;
+    std::vector <std::string> sink_specs;
+    int around = 0;
+    std::string page;
+    int top = 0;
+    std::string record;
+    std::string replay;
+    double speed = 1;
 
     for (int i = 1; i < argc; ++i)
     {
@@ -97,6 +251,29 @@ int main (int argc, char** argv)
                   << "  -d|--date       Prepend all lines with the current date\n"
                   << "  -t|--time       Prepend all lines with the current time\n"
                   << "  -f|--file       Override default ~/.clogrc\n"
+                  << "  --daemon        Serve clients on a socket, sharing one rule set\n"
+                  << "  --connect       Filter through a running daemon\n"
+                  << "  --socket <path> Override the default daemon socket\n"
+                  << "  -i|--input      Read a file, instead of stdin\n"
+                  << "  -F|--follow     Follow a file, instead of reading stdin\n"
+                  << "  --max-line <n>  Split lines longer than n bytes, 0 for no limit\n"
+                  << "  --truncate      Truncate long lines, instead of splitting them\n"
+                  << "  --since <time>  Show only lines timestamped at or after time\n"
+                  << "  --until <time>  Show only lines timestamped before time\n"
+                  << "  --only <n,...>  Show only lines hit by the numbered rules\n"
+                  << "  --build-index   Index the rule hits of the input files\n"
+                  << "  --summary       Count the lines hit by each rule, instead\n"
+                  << "  --bucket <n>    Count per n seconds, or n with suffix m, h or d\n"
+                  << "  --top <k>       Show the k most frequent line templates, instead\n"
+                  << "  --csv           Output counts as CSV\n"
+                  << "  --sink <m>:<f>  Also write to file f, as ansi, plain or rules=<n,...>\n"
+                  << "  --buffer <n>    Read ahead of a pipe up to n bytes, or with K, M, G\n"
+                  << "  --stats         Report line latency on SIGUSR1 and at exit\n"
+                  << "  -C|--context    Show <n> hidden lines before and after colored lines\n"
+                  << "  --pager <file>  Page through a file, applying rules to lines shown\n"
+                  << "  --record <file> Record input lines, with their arrival times\n"
+                  << "  --replay <file> Feed a recording to clog, and report its timing\n"
+                  << "  --speed <x>     Replay x times as fast as recorded, 0 for maximum\n"
                   << '\n';
         return status;
       }
@@ -124,12 +301,14 @@ int main (int argc, char** argv)
                ! strcmp (argv[i], "--date"))
       {
         prepend_date = true;
+        forward.push_back ("-d");
       }
 
       else if (! strcmp (argv[i], "-t") ||
                ! strcmp (argv[i], "--time"))
       {
         prepend_time = true;
+        forward.push_back ("-t");
       }
 
       else if (argc > i + 1 &&
@@ -139,60 +318,396 @@ int main (int argc, char** argv)
         rcFile = argv[++i];
       }
 
+      else if (! strcmp (argv[i], "--daemon"))
+      {
+        daemon = true;
+      }
+
+      else if (! strcmp (argv[i], "--connect"))
+      {
+        client = true;
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--socket"))
+      {
+        socket = argv[++i];
+      }
+
+      else if (argc > i + 1 &&
+               (! strcmp (argv[i], "-i") ||
+                ! strcmp (argv[i], "--input")))
+      {
+        inputs.push_back (argv[++i]);
+      }
+
+      else if (argc > i + 1 &&
+               (! strcmp (argv[i], "-F") ||
+                ! strcmp (argv[i], "--follow")))
+      {
+        follow.push_back (argv[++i]);
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--max-line"))
+      {
+        max_line = parseSize (argv[++i]);
+      }
+
+      else if (! strcmp (argv[i], "--truncate"))
+      {
+        truncate = true;
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--since"))
+      {
+        range.since (TimeRange::parse (argv[++i]));
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--until"))
+      {
+        range.until (TimeRange::parse (argv[++i]));
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--only"))
+      {
+        for (auto& number : split (argv[++i], ','))
+          only.push_back (number);
+      }
+
+      else if (! strcmp (argv[i], "--build-index"))
+      {
+        build_index = true;
+      }
+
+      else if (! strcmp (argv[i], "--summary"))
+      {
+        summarize = true;
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--bucket"))
+      {
+        bucket = Summary::duration (argv[++i]);
+        summarize = true;
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--top"))
+      {
+        top = parseCount (argv[++i]);
+        if (top == 0)
+          throw std::string ("Cannot parse count '0'.");
+      }
+
+      else if (! strcmp (argv[i], "--csv"))
+      {
+        csv = true;
+        summarize = true;
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--sink"))
+      {
+        sink_specs.push_back (argv[++i]);
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--buffer"))
+      {
+        budget = parseSize (argv[++i]);
+      }
+
+      else if (! strcmp (argv[i], "--stats"))
+      {
+        stats = true;
+      }
+
+      else if (argc > i + 1 &&
+               (! strcmp (argv[i], "-C") ||
+                ! strcmp (argv[i], "--context")))
+      {
+        around = parseCount (argv[++i]);
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--pager"))
+      {
+        page = argv[++i];
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--record"))
+      {
+        record = argv[++i];
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--replay"))
+      {
+        replay = argv[++i];
+      }
+
+      else if (argc > i + 1 &&
+               ! strcmp (argv[i], "--speed"))
+      {
+        speed = parseSpeed (argv[++i]);
+      }
+
       else
       {
         sections.push_back (argv[i]);
+        forward.push_back (argv[i]);
       }
     }
 
-    // Use a default section if one was not specified.
-    if (sections.size () == 0)
-      sections.push_back ("default");
+    // The client shim needs no rules, the daemon has them.
+    if (client)
+      return runClient (socket, forward);
+
+    // The replayed clog gets every other argument, and reads the rules.
+    if (replay != "")
+    {
+      std::vector <std::string> args;
+      for (int i = 0; i < argc; ++i)
+      {
+        if (i + 1 < argc &&
+            (! strcmp (argv[i], "--replay") ||
+             ! strcmp (argv[i], "--speed")))
+          ++i;
+        else
+          args.push_back (argv[i]);
+      }
+
+      return runReplay (replay, speed, args);
+    }
 
     // Read rc file.
     std::vector <Rule> rules;
     if (loadRules (rcFile, rules))
     {
-      Composite composite;
+      auto indexes = ruleIndexes (only, rules);
+
+      if (build_index)
+      {
+        if (inputs.size () == 0)
+          throw std::string ("Only files given with --input can be indexed.");
+
+        for (auto& file : inputs)
+          std::cout << "Indexed " << file << ", " << Index::build (file, rules, max_line, truncate) << " blocks.\n";
+
+        return status;
+      }
+
+      // Without a terminal to page on, the file is filtered as usual.
+      if (page != "")
+      {
+        if (isatty (STDOUT_FILENO))
+        {
+          Pager pager (rules, sections);
+          pager.open (page);
+          return pager.run ();
+        }
+
+        inputs.push_back (page);
+      }
+
+      if (daemon)
+        return runDaemon (rules, socket, max_line, truncate);
+
+      if (follow.size ())
+        return runFollow (rules, follow, sections, prepend_date, prepend_time,
+                          max_line, truncate, around);
+
+      Filter filter (rules, sections);
+      filter.prependDate (prepend_date);
+      filter.prependTime (prepend_time);
+      filter.context (around);
+
+      // Sinks share the evaluation of each line with the main output.
+      std::vector <std::unique_ptr <Sink>> sinks;
+      std::vector <std::size_t> watched;
+      bool plain = false;
+      for (auto& spec : sink_specs)
+      {
+        sinks.emplace_back (createSink (spec, rules));
+        plain = plain || sinks.back ()->mode () == Sink::Mode::plain;
+        for (auto index : sinks.back ()->rules ())
+          watched.push_back (index);
+      }
+
+      filter.watch (watched);
+      filter.passthrough (sinks.size () == 0);
+
+      Summary summary (rules, sections);
+      summary.bucket (bucket);
+      summary.csv (csv);
+
+      // Templates are shown again every second on a terminal.
+      std::unique_ptr <Templates> templates;
+      if (top)
+      {
+        templates.reset (new Templates (top));
+        templates->csv (csv);
+        templates->refresh (isatty (STDOUT_FILENO) && ! csv ? 1 : 0);
+      }
+
+      // Lines are recorded as read, before the time window or --only.
+      std::unique_ptr <Recording> recording;
+      if (record != "")
+      {
+        recording.reset (new Recording);
+        recording->create (record);
+      }
+
+      // Read stdin, unless files are specified.
+      if (inputs.size () == 0)
+        inputs.push_back ("-");
+
+      // Reads are restarted after a report, so it can be asked for while idle.
+      if (stats)
+      {
+        struct sigaction action {};
+        action.sa_handler = reportLatency;
+        action.sa_flags = SA_RESTART;
+        sigaction (SIGUSR1, &action, nullptr);
+      }
 
       // Main loop: read line, apply rules, write line.
+      Writer writer (STDOUT_FILENO);
       std::string line;
-      while (getline (std::cin, line)) // Strips \n
+      std::string output;
+      std::string uncolored;
+      for (auto& file : inputs)
       {
-        auto length = line.length ();
-        bool blanks = false;
-        applyRules (composite, blanks, rules, sections, line);
+        Input input;
+        input.budget (budget);
+        if (file == "-")
+          input.open (STDIN_FILENO);
+        else
+          input.open (file);
+
+        // Output is written before the input is read further, which may wait,
+        // and which reuses the buffer that lines passed through are written
+        // from.  All lines since the last read arrived with it.
+        unsigned long pending = 0;
+        auto drain = [&] ()
+        {
+          writer.flush ();
+          for (auto& sink : sinks)
+            sink->flush ();
 
-        if (blanks)
-          std::cout << "\n";
+          if (recording)
+            recording->flush ();
 
-        auto output = composite.str ();
-        if (output.length () || output.length () == length)
+          if (stats && pending)
+          {
+            latency.record (std::chrono::duration_cast <std::chrono::nanoseconds> (
+                              std::chrono::steady_clock::now () - input.arrival ()).count (),
+                            pending);
+            queued = input.queued ();
+            if (input.high () > queueHigh)
+              queueHigh = input.high ();
+          }
+
+          pending = 0;
+        };
+
+        input.drain (drain);
+
+        // Each file is searched for the window afresh, and with --only, read
+        // only where its index shows the rules hit.  Segments of a long line
+        // go with its first.
+        TimeRange window (range);
+        if (window.active ())
+          input.seek (window);
+
+        Index index;
+        if (indexes.size () && file != "-" && index.load (file, rules, max_line, truncate))
+          input.confine (index.spans (indexes));
+
+        input.limit (max_line, truncate);
+        bool admitted = true;
+        while (input.getline (line)) // Strips \n
         {
-          if (prepend_date || prepend_time)
+          if (recording)
+            recording->add (line, input.overlap (), input.cut (), input.arrival ());
+
+          if (input.overlap () == 0)
           {
-            time_t current;
-            time (&current);
-            struct tm* t = localtime (&current);
-
-            if (prepend_date)
-              std::cout << t->tm_year + 1900 << '-'
-                        << std::setw (2) << std::setfill ('0') << t->tm_mon + 1 << '-'
-                        << std::setw (2) << std::setfill ('0') << t->tm_mday    << ' ';
-
-            if (prepend_time)
-              std::cout << std::setw (2) << std::setfill ('0') << t->tm_hour << ':'
-                        << std::setw (2) << std::setfill ('0') << t->tm_min  << ':'
-                        << std::setw (2) << std::setfill ('0') << t->tm_sec  << ' ';
+            admitted = ! window.active () || window.admit (line);
+            if (window.past ())
+              break;
+
+            if (admitted && indexes.size ())
+              admitted = selected (rules, indexes, line);
           }
 
-          std::cout << output << "\n";
+          if (! admitted)
+            continue;
+
+          output.clear ();
+          if (templates)
+          {
+            templates->add (line, input.overlap () == 0, output);
+            if (output.length ())
+              std::cout << output << std::flush;
+          }
+          else if (summarize)
+          {
+            // A finished bucket is shown at once, for live input.
+            summary.add (line, input.overlap () == 0, output);
+            if (output.length ())
+              std::cout << output << std::flush;
+          }
+          else
+          {
+            // A line passed through is written from the input buffer, unless
+            // it is the last, and unterminated.
+            const char* data;
+            std::size_t length;
+            uncolored.clear ();
+            if (! filter.apply (line, output, plain ? &uncolored : nullptr, input.overlap (), input.cut ()))
+              writer.add (output);
+            else if (input.raw (data, length))
+              writer.borrow (data, length);
+            else
+            {
+              output = line;
+              output += '\n';
+              writer.add (output);
+            }
+
+            for (auto& sink : sinks)
+              sink->add (line, output, uncolored, filter, input.overlap (), input.cut ());
+
+            ++pending;
+          }
         }
 
-        if (blanks)
-          std::cout << "\n";
+        drain ();
+      }
 
-        composite.clear ();
+      if (templates)
+      {
+        output.clear ();
+        templates->finish (output);
+        std::cout << output;
+      }
+      else if (summarize)
+      {
+        output.clear ();
+        summary.finish (output);
+        std::cout << output;
+      }
+
+      if (stats)
+      {
+        std::cout.flush ();
+        reportLatency (0);
       }
     }
     else
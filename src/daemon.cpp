@@ -0,0 +1,519 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Filter.h>
+#include <LineBuffer.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+// Once this much rendered output is waiting for a slow client, stop reading
+// its input until it catches up.
+static const std::string::size_type MAX_PENDING = 1 << 20;
+
+static volatile sig_atomic_t terminated = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+static void handleTerminate (int)
+{
+  terminated = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The socket is per-user, so that daemons of different users do not collide.
+std::string defaultSocket ()
+{
+  auto runtime = getenv ("XDG_RUNTIME_DIR");
+  if (runtime && *runtime)
+    return std::string (runtime) + "/clog.sock";
+
+  return "/tmp/clog-" + std::to_string (getuid ()) + ".sock";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void socketAddress (const std::string& path, struct sockaddr_un& address)
+{
+  if (path.length () >= sizeof (address.sun_path))
+    throw std::string ("Socket path is too long: ") + path;
+
+  memset (&address, 0, sizeof (address));
+  address.sun_family = AF_UNIX;
+  strncpy (address.sun_path, path.c_str (), sizeof (address.sun_path) - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Client shim: forwards the arguments as a header, then copies stdin to the
+// daemon and the rendered result back to stdout.  Both directions are
+// multiplexed, so that a daemon applying backpressure cannot deadlock us.  A
+// daemon that goes away before it has all the input is an error.
+int runClient (
+  const std::string& path,
+  const std::vector <std::string>& args)
+{
+  struct sockaddr_un address;
+  socketAddress (path, address);
+
+  int sock = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (sock == -1)
+    throw std::string ("Could not create socket: ") + strerror (errno);
+
+  if (connect (sock, (struct sockaddr*) &address, sizeof (address)) == -1)
+  {
+    close (sock);
+    throw std::string ("Could not connect to clog daemon at ") + path + ": " + strerror (errno);
+  }
+
+  signal (SIGPIPE, SIG_IGN);
+
+  // The header is the number of arguments on a line, then each argument
+  // terminated by a NUL, which is the one byte an argument cannot hold.
+  std::string pending = std::to_string (args.size ()) + '\n';
+  for (auto& arg : args)
+  {
+    pending += arg;
+    pending += '\0';
+  }
+
+  std::string::size_type sent = 0;
+  bool input_open = true;
+  bool lost = false;
+  char buffer[65536];
+
+  while (true)
+  {
+    struct pollfd fds[2];
+    fds[0].fd      = sock;
+    fds[0].events  = POLLIN | (sent < pending.length () ? POLLOUT : 0);
+    fds[0].revents = 0;
+    fds[1].fd      = STDIN_FILENO;
+    fds[1].events  = POLLIN;
+    fds[1].revents = 0;
+
+    // Only read more input once everything read so far has been sent.
+    nfds_t count = (input_open && sent == pending.length ()) ? 2 : 1;
+    if (poll (fds, count, -1) == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      throw std::string ("poll failed: ") + strerror (errno);
+    }
+
+    if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+    {
+      auto got = read (sock, buffer, sizeof (buffer));
+      if (got == -1 && errno == EINTR)
+        continue;
+
+      if (got <= 0)
+      {
+        lost = got == -1 || input_open || sent < pending.length ();
+        break;
+      }
+
+      std::cout.write (buffer, got);
+      std::cout.flush ();
+    }
+
+    if (fds[0].revents & POLLOUT)
+    {
+      auto put = write (sock, pending.data () + sent, pending.length () - sent);
+      if (put == -1 && errno != EAGAIN && errno != EINTR)
+      {
+        lost = true;
+        break;
+      }
+
+      if (put > 0)
+        sent += put;
+
+      if (sent == pending.length ())
+      {
+        pending.clear ();
+        sent = 0;
+        if (! input_open)
+          shutdown (sock, SHUT_WR);
+      }
+    }
+
+    if (count == 2 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR)))
+    {
+      auto got = read (STDIN_FILENO, buffer, sizeof (buffer));
+      if (got > 0)
+      {
+        pending.assign (buffer, got);
+        sent = 0;
+      }
+      else if (got == 0 || errno != EINTR)
+      {
+        input_open = false;
+        shutdown (sock, SHUT_WR);
+      }
+    }
+  }
+
+  close (sock);
+  if (lost)
+    throw std::string ("Lost the connection to the clog daemon at ") + path + '.';
+
+  return 0;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+////////////////////////////////////////////////////////////////////////////////
+// Per-connection state.  The header, which carries the command line arguments
+// of the client shim, is gathered first, and everything after it is input to
+// be filtered.
+class Client
+{
+public:
+  explicit Client (int fd) : _fd (fd) {}
+
+  int                         _fd;
+  std::string                 _header {};
+  LineBuffer                  _lines  {};
+  std::string                 _line   {};
+  std::string                 _output {};
+  std::string::size_type      _sent   {0};
+  bool                        _eof    {false};
+  std::unique_ptr <Filter>    _filter {};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Accepts the same options the client does.
+static Filter* createFilter (std::vector <Rule>& rules, const std::vector <std::string>& args)
+{
+  std::vector <std::string> sections;
+  bool prepend_date = false;
+  bool prepend_time = false;
+
+  for (auto& arg : args)
+  {
+         if (arg == "-d" || arg == "--date")       prepend_date = true;
+    else if (arg == "-t" || arg == "--time")       prepend_time = true;
+    else                                           sections.push_back (arg);
+  }
+
+  auto filter = new Filter (rules, sections);
+  filter->prependDate (prepend_date);
+  filter->prependTime (prepend_time);
+  return filter;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Gathers the header, as the client shim sends it, and once it is complete,
+// creates the filter and passes whatever follows it on as input.  Returns false
+// if the header is malformed, or implausibly long.
+static bool readHeader (
+  std::vector <Rule>& rules,
+  Client& client,
+  const char* data,
+  std::string::size_type size)
+{
+  auto& header = client._header;
+  header.append (data, size);
+
+  auto eol = header.find ('\n');
+  if (eol == std::string::npos)
+    return header.length () < MAX_PENDING;
+
+  if (eol == 0 || header.find_first_not_of ("0123456789") != eol)
+    return false;
+
+  auto count = strtoul (header.c_str (), nullptr, 10);
+  std::vector <std::string> args;
+  auto start = eol + 1;
+  while (args.size () < count)
+  {
+    auto end = header.find ('\0', start);
+    if (end == std::string::npos)
+      return header.length () < MAX_PENDING;
+
+    args.push_back (header.substr (start, end - start));
+    start = end + 1;
+  }
+
+  client._filter.reset (createFilter (rules, args));
+  client._lines.append (header.data () + start, header.length () - start);
+  header.clear ();
+  header.shrink_to_fit ();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Filters every complete line buffered for the client.  At end of input, a
+// final unterminated line is treated as a line, just like getline does.
+static void processInput (Client& client)
+{
+  auto& lines = client._lines;
+  auto& line  = client._line;
+  while (lines.next (line) ||
+         (client._eof && lines.finish (line)))
+    client._filter->apply (line, client._output, lines.overlap (), lines.cut ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void updateEvents (int epoll, Client& client)
+{
+  struct epoll_event event;
+  memset (&event, 0, sizeof (event));
+  event.data.fd = client._fd;
+
+  if (! client._eof && client._output.length () - client._sent < MAX_PENDING)
+    event.events |= EPOLLIN;
+
+  if (client._sent < client._output.length ())
+    event.events |= EPOLLOUT;
+
+  epoll_ctl (epoll, EPOLL_CTL_MOD, client._fd, &event);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Binds the listening socket.  A socket left behind by a daemon that is no
+// longer running is replaced, but a live daemon is never displaced, and nor is
+// anything that is not a socket.  Startup holds a lock on <path>.lock, which
+// the daemon keeps, so that of two daemons starting at once, one gives up.
+// The socket is bound and listening under a temporary name before it is
+// renamed into place, so that a client never finds it before it accepts
+// connections.
+static int listenOn (const std::string& path, int& lock)
+{
+  struct sockaddr_un address;
+  socketAddress (path, address);
+
+  auto lockPath = path + ".lock";
+  lock = open (lockPath.c_str (), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (lock == -1)
+    throw std::string ("Could not open ") + lockPath + ": " + strerror (errno);
+
+  if (flock (lock, LOCK_EX | LOCK_NB) == -1)
+  {
+    close (lock);
+    throw std::string ("A clog daemon is already listening on ") + path;
+  }
+
+  struct stat st;
+  if (lstat (path.c_str (), &st) == 0 && ! S_ISSOCK (st.st_mode))
+  {
+    close (lock);
+    throw std::string ("Not replacing ") + path + ", which is not a socket.";
+  }
+
+  int probe = socket (AF_UNIX, SOCK_STREAM, 0);
+  bool live = connect (probe, (struct sockaddr*) &address, sizeof (address)) == 0;
+  close (probe);
+  if (live)
+  {
+    close (lock);
+    throw std::string ("A clog daemon is already listening on ") + path;
+  }
+
+  auto temporary = path + '.' + std::to_string (getpid ());
+  socketAddress (temporary, address);
+  unlink (temporary.c_str ());
+
+  int sock = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (sock == -1)
+  {
+    auto error = errno;
+    close (lock);
+    throw std::string ("Could not create socket: ") + strerror (error);
+  }
+
+  if (bind (sock, (struct sockaddr*) &address, sizeof (address)) == -1)
+  {
+    auto error = errno;
+    close (sock);
+    close (lock);
+    throw std::string ("Could not bind ") + path + ": " + strerror (error);
+  }
+
+  chmod (temporary.c_str (), S_IRUSR | S_IWUSR);
+
+  if (listen (sock, SOMAXCONN) == -1 ||
+      rename (temporary.c_str (), path.c_str ()) == -1)
+  {
+    auto error = errno;
+    close (sock);
+    close (lock);
+    unlink (temporary.c_str ());
+    throw std::string ("Could not listen on ") + path + ": " + strerror (error);
+  }
+
+  return sock;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Daemon: one thread, one epoll set, one compiled rule set shared by all
+// clients.  Each client has its own sections and options, and therefore its
+// own Filter.
+int runDaemon (
+  std::vector <Rule>& rules,
+  const std::string& path,
+  std::string::size_type limit,
+  bool truncate)
+{
+  int lock;
+  int server = listenOn (path, lock);
+
+  int epoll = epoll_create1 (EPOLL_CLOEXEC);
+  if (epoll == -1)
+    throw std::string ("Could not create epoll instance: ") + strerror (errno);
+
+  struct epoll_event event;
+  memset (&event, 0, sizeof (event));
+  event.events = EPOLLIN;
+  event.data.fd = server;
+  epoll_ctl (epoll, EPOLL_CTL_ADD, server, &event);
+
+  signal (SIGPIPE, SIG_IGN);
+  signal (SIGINT,  handleTerminate);
+  signal (SIGTERM, handleTerminate);
+
+  std::map <int, std::unique_ptr <Client>> clients;
+  struct epoll_event events[64];
+  char buffer[65536];
+
+  while (! terminated)
+  {
+    int count = epoll_wait (epoll, events, 64, -1);
+    if (count == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      throw std::string ("epoll_wait failed: ") + strerror (errno);
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+      int fd = events[i].data.fd;
+
+      if (fd == server)
+      {
+        int accepted;
+        while ((accepted = accept4 (server, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1)
+        {
+          clients[accepted].reset (new Client (accepted));
+          clients[accepted]->_lines.limit (limit, truncate);
+
+          memset (&event, 0, sizeof (event));
+          event.events = EPOLLIN;
+          event.data.fd = accepted;
+          epoll_ctl (epoll, EPOLL_CTL_ADD, accepted, &event);
+        }
+
+        continue;
+      }
+
+      auto found = clients.find (fd);
+      if (found == clients.end ())
+        continue;
+
+      auto& client = *found->second;
+      bool failed = false;
+
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR) && ! client._eof)
+      {
+        auto got = read (fd, buffer, sizeof (buffer));
+        if (got > 0 && client._filter)
+          client._lines.append (buffer, got);
+        else if (got > 0)
+          failed = ! readHeader (rules, client, buffer, got);
+        else if (got == 0)
+          client._eof = true;
+        else if (errno != EAGAIN && errno != EINTR)
+          failed = true;
+
+        if (client._filter)
+          processInput (client);
+      }
+
+      if (client._sent < client._output.length ())
+      {
+        auto put = write (fd, client._output.data () + client._sent, client._output.length () - client._sent);
+        if (put > 0)
+          client._sent += put;
+        else if (put == -1 && errno != EAGAIN && errno != EINTR)
+          failed = true;
+
+        if (client._sent == client._output.length ())
+        {
+          client._output.clear ();
+          client._sent = 0;
+        }
+      }
+
+      if (failed || (client._eof && client._output.length () == 0))
+      {
+        epoll_ctl (epoll, EPOLL_CTL_DEL, fd, nullptr);
+        close (fd);
+        clients.erase (found);
+      }
+      else
+        updateEvents (epoll, client);
+    }
+  }
+
+  for (auto& client : clients)
+    close (client.first);
+
+  close (epoll);
+  close (server);
+  unlink (path.c_str ());
+  close (lock);
+  return 0;
+}
+
+#else
+////////////////////////////////////////////////////////////////////////////////
+int runDaemon (std::vector <Rule>&, const std::string&, std::string::size_type, bool)
+{
+  throw std::string ("Daemon mode is not supported on this platform.");
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
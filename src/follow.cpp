@@ -0,0 +1,311 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Filter.h>
+#include <LineBuffer.h>
+#include <shared.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined (HAVE_SYS_INOTIFY_H) && defined (HAVE_SYS_EPOLL_H)
+#include <sys/inotify.h>
+#include <sys/epoll.h>
+#endif
+
+#if defined (HAVE_SYS_INOTIFY_H) && defined (HAVE_SYS_EPOLL_H)
+static const std::string::size_type CHUNK_SIZE = 1 << 16;
+
+////////////////////////////////////////////////////////////////////////////////
+// One followed file.  The file is identified by path, not by inode, so that
+// after rotation the new file at the same path is followed.
+class Followed
+{
+public:
+  Followed (std::vector <Rule>& rules, const std::vector <std::string>& sections)
+  : _filter (rules, sections)
+  {
+  }
+
+  std::string _path      {};
+  std::string _directory {};
+  std::string _name      {};
+  int         _fd        {-1};
+  off_t       _offset    {0};
+  LineBuffer  _lines     {};
+  Filter      _filter;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// <file>[:<section>[,<section>...][:<tag>]]
+// The spec is split from the right, at most twice, so that the file name may
+// hold colons.
+static Followed* parseSpec (
+  std::vector <Rule>& rules,
+  const std::string& spec,
+  const std::vector <std::string>& defaults)
+{
+  std::vector <std::string> parts {spec};
+  std::string::size_type colon;
+  while (parts.size () < 3 &&
+         (colon = parts[0].rfind (':')) != std::string::npos)
+  {
+    parts.insert (parts.begin () + 1, parts[0].substr (colon + 1));
+    parts[0].resize (colon);
+  }
+
+  if (parts[0] == "")
+    throw std::string ("Invalid --follow argument: ") + spec;
+
+  std::vector <std::string> sections;
+  if (parts.size () > 1)
+    for (auto& section : split (parts[1], ','))
+      if (section != "")
+        sections.push_back (section);
+
+  auto followed = new Followed (rules, sections.size () ? sections : defaults);
+  followed->_path = parts[0];
+  if (parts.size () > 2 && parts[2] != "")
+    followed->_filter.tag (parts[2]);
+
+  auto slash = followed->_path.rfind ('/');
+  if (slash == std::string::npos)
+  {
+    followed->_directory = ".";
+    followed->_name = followed->_path;
+  }
+  else
+  {
+    followed->_directory = slash ? followed->_path.substr (0, slash) : "/";
+    followed->_name = followed->_path.substr (slash + 1);
+  }
+
+  return followed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads only the bytes appended since the last read, and filters the complete
+// lines among them.  A file that shrank was truncated in place, and is read
+// again from the start.
+static void readAppended (Followed& file, std::string& line, std::string& output)
+{
+  if (file._fd == -1)
+    return;
+
+  struct stat st;
+  if (fstat (file._fd, &st) == 0 && st.st_size < file._offset)
+  {
+    file._offset = 0;
+    file._lines.clear ();
+  }
+
+  while (true)
+  {
+    auto got = pread (file._fd, file._lines.reserve (CHUNK_SIZE), CHUNK_SIZE, file._offset);
+    file._lines.commit (got > 0 ? got : 0);
+    if (got <= 0)
+      break;
+
+    file._offset += got;
+    while (file._lines.next (line))
+      file._filter.apply (line, output, file._lines.overlap (), file._lines.cut ());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Opens the file at the path.  Existing content is skipped at startup, but a
+// file that appears later, typically after rotation, is read from the start.
+static void reopen (Followed& file, bool skip_existing, std::string& line, std::string& output)
+{
+  if (file._fd != -1)
+  {
+    // Drain whatever the writer added to the old file before it moved.
+    readAppended (file, line, output);
+    if (file._lines.finish (line))
+      file._filter.apply (line, output, file._lines.overlap (), file._lines.cut ());
+
+    close (file._fd);
+  }
+
+  file._fd = open (file._path.c_str (), O_RDONLY | O_CLOEXEC);
+  file._offset = 0;
+
+  struct stat st;
+  if (skip_existing && file._fd != -1 && fstat (file._fd, &st) == 0)
+    file._offset = st.st_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void flush (std::string& output)
+{
+  if (output.length ())
+  {
+    std::cout << output;
+    std::cout.flush ();
+    output.clear ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Follows several files in one process.  The parent directories are watched,
+// rather than the files, so that one watch covers appends, creation and
+// rotation by rename for every followed file in that directory.  Output from
+// all files is merged, one whole line at a time.
+int runFollow (
+  std::vector <Rule>& rules,
+  const std::vector <std::string>& specs,
+  const std::vector <std::string>& sections,
+  bool prepend_date,
+  bool prepend_time,
+  std::string::size_type limit,
+  bool truncate,
+  int around)
+{
+  std::vector <std::unique_ptr <Followed>> files;
+  for (auto& spec : specs)
+  {
+    files.emplace_back (parseSpec (rules, spec, sections));
+    files.back ()->_filter.prependDate (prepend_date);
+    files.back ()->_filter.prependTime (prepend_time);
+    files.back ()->_filter.context (around);
+    files.back ()->_lines.limit (limit, truncate);
+  }
+
+  int notify = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+  if (notify == -1)
+    throw std::string ("Could not initialize inotify: ") + strerror (errno);
+
+  std::string line;
+  std::string output;
+  std::map <std::pair <int, std::string>, Followed*> watched;
+  for (auto& file : files)
+  {
+    int wd = inotify_add_watch (notify, file->_directory.c_str (),
+                                IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE);
+    if (wd == -1)
+      throw std::string ("Could not watch ") + file->_directory + ": " + strerror (errno);
+
+    // One file followed twice, perhaps by another path to it, would get the
+    // events of only one of them.
+    auto key = std::make_pair (wd, file->_name);
+    if (watched.count (key))
+      throw std::string ("Cannot follow ") + file->_path + " more than once.";
+
+    watched[key] = file.get ();
+    reopen (*file, true, line, output);
+  }
+
+  int epoll = epoll_create1 (EPOLL_CLOEXEC);
+  if (epoll == -1)
+    throw std::string ("Could not create epoll instance: ") + strerror (errno);
+
+  struct epoll_event event;
+  memset (&event, 0, sizeof (event));
+  event.events = EPOLLIN;
+  event.data.fd = notify;
+  epoll_ctl (epoll, EPOLL_CTL_ADD, notify, &event);
+
+  // Events are aligned for struct inotify_event.
+  char buffer[65536] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+
+  while (true)
+  {
+    // The timeout is a fallback for file systems that do not deliver inotify
+    // events, such as NFS.
+    struct epoll_event ready;
+    int count = epoll_wait (epoll, &ready, 1, 1000);
+    if (count == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      throw std::string ("epoll_wait failed: ") + strerror (errno);
+    }
+
+    if (count == 0)
+    {
+      for (auto& file : files)
+        readAppended (*file, line, output);
+
+      flush (output);
+      continue;
+    }
+
+    ssize_t got;
+    while ((got = read (notify, buffer, sizeof (buffer))) > 0)
+    {
+      for (char* p = buffer; p < buffer + got; )
+      {
+        auto notification = (struct inotify_event*) p;
+        p += sizeof (struct inotify_event) + notification->len;
+
+        if (! notification->len)
+          continue;
+
+        auto found = watched.find (std::make_pair (notification->wd, std::string (notification->name)));
+        if (found == watched.end ())
+          continue;
+
+        if (notification->mask & (IN_CREATE | IN_MOVED_TO))
+          reopen (*found->second, false, line, output);
+        else
+          readAppended (*found->second, line, output);
+      }
+    }
+
+    flush (output);
+  }
+
+  return 0;
+}
+
+#else
+////////////////////////////////////////////////////////////////////////////////
+int runFollow (
+  std::vector <Rule>&,
+  const std::vector <std::string>&,
+  const std::vector <std::string>&,
+  bool,
+  bool,
+  std::string::size_type,
+  bool,
+  int)
+{
+  throw std::string ("Follow mode is not supported on this platform.");
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
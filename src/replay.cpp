@@ -0,0 +1,288 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Histogram.h>
+#include <Recording.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// How far ahead of the pipe lines are queued, which bounds memory, not pace.
+static const std::string::size_type BLOCK_SIZE = 1 << 16;
+
+////////////////////////////////////////////////////////////////////////////////
+static void seconds (std::ostream& out, std::chrono::steady_clock::duration duration)
+{
+  char text[32];
+  snprintf (text, sizeof (text), "%.3fs",
+            std::chrono::duration_cast <std::chrono::microseconds> (duration).count () / 1e6);
+  out << text;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Feeds a recording to clog, run with the given arguments, through a pipe.  A
+// line is sent when it is due, at the pace it was recorded, scaled by speed,
+// or as fast as clog reads with speed 0.  Output is counted and discarded.
+// The n-th line of output is taken to be the n-th line of input, so latency
+// is only meaningful when rules neither suppress nor add lines.  A paced line
+// counts from when it was due, so that a stalled clog does not hide its own
+// delay, and otherwise from when it was written to the pipe.
+int runReplay (
+  const std::string& file,
+  double speed,
+  const std::vector <std::string>& args)
+{
+  Recording recording;
+  recording.open (file);
+
+  int in[2], out[2];
+  if (pipe2 (in, O_CLOEXEC) == -1 || pipe2 (out, O_CLOEXEC) == -1)
+    throw std::string ("Could not create pipe: ") + strerror (errno);
+
+  auto pid = fork ();
+  if (pid == -1)
+    throw std::string ("Could not fork: ") + strerror (errno);
+
+  if (pid == 0)
+  {
+    dup2 (in[0], STDIN_FILENO);
+    dup2 (out[1], STDOUT_FILENO);
+
+    std::vector <char*> argv;
+    for (auto& arg : args)
+      argv.push_back ((char*) arg.c_str ());
+    argv.push_back (nullptr);
+
+    // This very executable, however it was invoked, and from wherever.  Only
+    // without /proc is it looked up by name.
+    execv ("/proc/self/exe", argv.data ());
+    if (errno == ENOENT)
+      execvp (argv[0], argv.data ());
+
+    std::cerr << "Cannot run " << args[0] << ": " << strerror (errno) << "\n";
+    _exit (127);
+  }
+
+  close (in[0]);
+  close (out[1]);
+  fcntl (in[1], F_SETFL, fcntl (in[1], F_GETFL) | O_NONBLOCK);
+  signal (SIGPIPE, SIG_IGN);
+
+  typedef std::chrono::steady_clock Clock;
+  Histogram latency;
+  std::string pending;
+  std::string::size_type written = 0;
+  std::uint64_t queued = 0;
+  std::uint64_t sent = 0;
+  std::deque <std::pair <std::uint64_t, Clock::time_point>> unsent;
+  std::deque <Clock::time_point> waiting;
+
+  unsigned long lines = 0;
+  unsigned long long bytes = 0;
+  unsigned long output_lines = 0;
+  unsigned long long output_bytes = 0;
+  std::uint64_t recorded = 0;
+
+  std::uint64_t delay;
+  const char* data;
+  std::size_t length;
+  bool last;
+  bool more = recording.next (delay, data, length, last);
+
+  auto start = Clock::now ();
+  auto due = start;
+  bool reading = true;
+  char buffer[65536];
+
+  while (reading)
+  {
+    // Queue every line that is due.
+    auto now = Clock::now ();
+    while (more && pending.length () - written < BLOCK_SIZE && (speed == 0 || due <= now))
+    {
+      // A long line comes in pieces, and only counts once it is complete.
+      pending.append (data, length);
+      queued += length;
+      bytes += length;
+      if (last)
+      {
+        pending += '\n';
+        unsent.push_back ({++queued, due});
+        ++lines;
+        ++bytes;
+      }
+
+      more = recording.next (delay, data, length, last);
+      if (more)
+      {
+        recorded += delay;
+        if (speed > 0)
+          due += std::chrono::duration_cast <Clock::duration> (
+                   std::chrono::duration <double, std::micro> (delay / speed));
+      }
+    }
+
+    // End of input, once everything is sent.
+    if (! more && written == pending.length () && in[1] != -1)
+    {
+      close (in[1]);
+      in[1] = -1;
+    }
+
+    struct pollfd fds[2] {{out[0], POLLIN, 0}, {in[1], POLLOUT, 0}};
+    nfds_t count = (in[1] != -1 && written < pending.length ()) ? 2 : 1;
+
+    // Waits are rounded down, and the last millisecond before a line is due
+    // is spun, so that lines are not sent late.
+    int timeout = -1;
+    if (more && speed > 0)
+      timeout = std::max ((long) 0, (long) std::chrono::duration_cast <std::chrono::milliseconds> (
+                                             due - now).count ());
+
+    if (poll (fds, count, timeout) == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      throw std::string ("Poll error: ") + strerror (errno);
+    }
+
+    now = Clock::now ();
+    if (count == 2 && fds[1].revents)
+    {
+      auto got = write (in[1], pending.data () + written, pending.length () - written);
+      if (got == -1 && errno != EAGAIN && errno != EINTR)
+      {
+        // clog went away, and takes no more input.
+        more = false;
+        pending.clear ();
+        written = 0;
+        close (in[1]);
+        in[1] = -1;
+      }
+      else if (got > 0)
+      {
+        written += got;
+        sent += got;
+        while (unsent.size () && unsent.front ().first <= sent)
+        {
+          waiting.push_back (speed > 0 ? unsent.front ().second : now);
+          unsent.pop_front ();
+        }
+
+        // What is written is dropped, so that at most a block is held back
+        // from the pipe, plus a block already written.
+        if (written == pending.length ())
+        {
+          pending.clear ();
+          written = 0;
+        }
+        else if (written >= BLOCK_SIZE)
+        {
+          pending.erase (0, written);
+          written = 0;
+        }
+      }
+    }
+
+    if (fds[0].revents)
+    {
+      auto got = read (out[0], buffer, sizeof (buffer));
+      if (got == -1 && errno == EINTR)
+        continue;
+
+      if (got <= 0)
+      {
+        reading = false;
+        continue;
+      }
+
+      output_bytes += got;
+      auto end = buffer + got;
+      for (auto p = buffer; (p = (char*) memchr (p, '\n', end - p)) != nullptr; ++p)
+      {
+        ++output_lines;
+        if (waiting.size ())
+        {
+          latency.record (std::chrono::duration_cast <std::chrono::nanoseconds> (now - waiting.front ()).count ());
+          waiting.pop_front ();
+        }
+      }
+    }
+  }
+
+  auto elapsed = Clock::now () - start;
+  if (in[1] != -1)
+    close (in[1]);
+  close (out[0]);
+
+  int status = 0;
+  while (waitpid (pid, &status, 0) == -1 && errno == EINTR)
+    ;
+
+  std::cout << "replay: lines " << lines << ", bytes " << bytes << ", recorded ";
+  seconds (std::cout, std::chrono::microseconds (recorded));
+  std::cout << ", replayed ";
+  seconds (std::cout, elapsed);
+  if (speed > 0)
+    std::cout << " at " << speed << "x\n";
+  else
+    std::cout << " at maximum speed\n";
+
+  auto elapsed_seconds = std::chrono::duration_cast <std::chrono::microseconds> (elapsed).count () / 1e6;
+  char rate[32];
+  snprintf (rate, sizeof (rate), "%.0f", elapsed_seconds > 0 ? output_lines / elapsed_seconds : 0.0);
+  std::cout << "replay: output lines " << output_lines << ", bytes " << output_bytes
+            << ", " << rate << " lines/s";
+  if (output_lines < lines)
+    std::cout << ", " << lines - output_lines << " fewer than input";
+  else if (output_lines > lines)
+    std::cout << ", " << output_lines - lines << " more than input";
+  std::cout << "\n";
+
+  char report[512];
+  auto size = latency.format (report, sizeof (report));
+  std::cout << "replay: latency ";
+  std::cout.write (report, size);
+
+  return WIFEXITED (status) ? WEXITSTATUS (status) : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
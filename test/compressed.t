@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import gzip
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestInput(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red line')
+        self.path = os.path.join(self.t.datadir, "input.log")
+
+    def test_input_files(self):
+        """Test reading several files instead of stdin"""
+        with open(self.path, "w") as f:
+            f.write("a foo\nbar")
+        code, out, err = self.t("--input {0} -i {0}".format(self.path))
+        self.assertEqual('\x1b[31ma foo\x1b[0m\nbar\n' * 2, out)
+
+    def test_input_missing(self):
+        """Test that a missing input file is an error"""
+        code, out, err = self.t.runError("--input " + self.path + ".missing")
+        self.assertIn("Cannot open", out)
+
+
+class TestGzip(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red line')
+        self.data = "".join("line {0} foo\nline {0} bar\n".format(i) for i in range(20000))
+        code, self.expected, err = self.t("", input=self.data.encode())
+
+    def test_gzip_stdin(self):
+        """Test decompressing gzip input on stdin"""
+        code, out, err = self.t("", input=gzip.compress(self.data.encode()))
+        self.assertEqual(self.expected, out)
+
+    def test_gzip_file(self):
+        """Test decompressing a gzip file"""
+        path = os.path.join(self.t.datadir, "input.log.gz")
+        with open(path, "wb") as f:
+            f.write(gzip.compress(self.data.encode()))
+        code, out, err = self.t("--input " + path)
+        self.assertEqual(self.expected, out)
+
+    def test_gzip_members(self):
+        """Test decompressing concatenated gzip members"""
+        half = len(self.data) // 2
+        data = gzip.compress(self.data[:half].encode()) + gzip.compress(self.data[half:].encode())
+        code, out, err = self.t("", input=data)
+        self.assertEqual(self.expected, out)
+
+    def test_gzip_padded(self):
+        """Test that zero padding after the last gzip member ends the input"""
+        path = os.path.join(self.t.datadir, "padded.log.gz")
+        with open(path, "wb") as f:
+            f.write(gzip.compress(self.data.encode()) + b"\0" * 100000)
+        code, out, err = self.t("--input " + path)
+        self.assertEqual(self.expected, out)
+
+    def test_gzip_garbage_after_padding(self):
+        """Test that anything but zeros after the padding is an error"""
+        data = gzip.compress(self.data.encode()) + b"\0" * 10 + b"junk"
+        code, out, err = self.t.runError("", input=data)
+        self.assertIn("Corrupt gzip input.", out)
+
+    def test_gzip_truncated(self):
+        """Test that truncated gzip input is an error"""
+        data = gzip.compress(self.data.encode())
+        code, out, err = self.t.runError("", input=data[:len(data) // 2])
+        self.assertIn("Truncated gzip input.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
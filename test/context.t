@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+
+class TestContext(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule /^debug/ --> suppress')
+
+    def test_rule_context(self):
+        """Test showing suppressed lines around a hit"""
+        self.t.config('default rule /panic/ --> red line context=2')
+        code, out, err = self.t("", input="debug 1\ndebug 2\ninfo 3\ndebug 4\npanic 5\ndebug 6\ninfo 7\ndebug 8\ndebug 9\n".encode())
+        self.assertEqual("info 3\ndebug 4\n\x1b[31mpanic 5\x1b[0m\ndebug 6\ninfo 7\n", out)
+
+    def test_global_context(self):
+        """Test --context for every coloring rule"""
+        self.t.config('default rule /error/ --> red match')
+        code, out, err = self.t("--context 1", input="debug 1\ndebug 2\nan error\ndebug 3\ndebug 4\n".encode())
+        self.assertEqual("debug 2\nan \x1b[31merror\x1b[0m\ndebug 3\n", out)
+
+    def test_overlapping_context(self):
+        """Test that hits close together show each line once"""
+        self.t.config('default rule /panic/ --> line context=1')
+        code, out, err = self.t("", input="debug 1\npanic 2\ndebug 3\npanic 4\ndebug 5\ndebug 6\n".encode())
+        self.assertEqual("debug 1\npanic 2\ndebug 3\npanic 4\ndebug 5\n", out)
+
+    def test_mixed_rule_context(self):
+        """Test that a rule shows only its own context, beside a wider one"""
+        self.t.config('default rule /^h/ --> suppress')
+        self.t.config('default rule "A" --> red line context=1')
+        self.t.config('default rule "B" --> blue line context=5')
+        code, out, err = self.t("", input="h1\nh2\nh3\nh4\nh5\nA hit\nh6\nh7\nh8\n".encode())
+        self.assertEqual("h5\n\x1b[31mA hit\x1b[0m\nh6\n", out)
+
+    def test_rule_overrides_global(self):
+        """Test that context=0 on a rule overrides --context"""
+        self.t.config('default rule /quiet/ --> blue line context=0')
+        code, out, err = self.t("-C 3", input="debug 1\nquiet 2\ndebug 3\n".encode())
+        self.assertEqual("\x1b[34mquiet 2\x1b[0m\n", out)
+
+    def test_invalid_context(self):
+        """Test that an invalid count is an error"""
+        code, out, err = self.t.runError("--context x", input="x\n".encode())
+        self.assertIn("Cannot parse count 'x'.", out)
+
+    def test_invalid_rule_context(self):
+        """Test that an invalid context on a rule is an error"""
+        for count in ["99999999999", "-1", "2.5", "x", ""]:
+            self.t = Clog()
+            self.t.config('default rule /panic/ --> red line context=' + count)
+            code, out, err = self.t.runError("", input="panic\n".encode())
+            self.assertIn("Invalid context '" + count + "' in rule.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
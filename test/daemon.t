@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import time
+import fcntl
+import platform
+import unittest
+from subprocess import Popen, PIPE
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+@unittest.skipIf(platform.system() != "Linux", "Daemon mode requires epoll")
+class TestDaemon(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red line')
+        self.t.config('other   rule "bar" --> suppress')
+        self.socket = os.path.join(self.t.datadir, "clog.sock")
+        self.daemon = Popen([self.t.clog, "-f", self.t.clogrc,
+                             "--daemon", "--socket", self.socket],
+                            stdout=PIPE, stderr=PIPE)
+        for _ in range(100):
+            if os.path.exists(self.socket):
+                break
+            time.sleep(0.05)
+
+    def tearDown(self):
+        """Executed after each test in the class"""
+        self.daemon.terminate()
+        self.daemon.wait()
+
+    def test_daemon_default_section(self):
+        """Test filtering through the daemon with the default section"""
+        code, out, err = self.t("--connect --socket " + self.socket,
+                                input="a foo\nbar\n".encode())
+        self.assertEqual('\x1b[31ma foo\x1b[0m\nbar\n', out)
+
+    def test_daemon_sections(self):
+        """Test that each client names its own sections"""
+        code, out, err = self.t("--connect --socket " + self.socket + " default other",
+                                input="a foo\nbar\nbaz".encode())
+        self.assertEqual('\x1b[31ma foo\x1b[0m\nbaz\n', out)
+
+    def test_daemon_arguments_with_spaces(self):
+        """Test that an argument holding a space is passed on whole"""
+        code, direct, err = self.t("'default other'", input="a foo\nbar\n".encode())
+        code, served, err = self.t("--connect --socket " + self.socket + " 'default other'",
+                                   input="a foo\nbar\n".encode())
+        self.assertEqual("a foo\nbar\n", direct)
+        self.assertEqual(direct, served)
+
+    def test_daemon_matches_direct(self):
+        """Test that daemon output is identical to direct output"""
+        data = "".join("line {0} foo bar\n".format(i) for i in range(5000))
+        code, direct, err = self.t("default", input=data.encode())
+        code, served, err = self.t("--connect --socket " + self.socket,
+                                   input=data.encode())
+        self.assertEqual(direct, served)
+
+    def test_daemon_not_a_socket(self):
+        """Test that a daemon does not replace a file that is not a socket"""
+        path = os.path.join(self.t.datadir, "plain")
+        with open(path, "w") as f:
+            f.write("keep\n")
+
+        code, out, err = self.t.runError("--daemon --socket " + path)
+        self.assertIn("which is not a socket", out)
+        with open(path) as f:
+            self.assertEqual("keep\n", f.read())
+
+    def test_daemon_already_starting(self):
+        """Test that a daemon gives up while another holds the startup lock"""
+        path = os.path.join(self.t.datadir, "other.sock")
+        with open(path + ".lock", "w") as lock:
+            fcntl.flock(lock, fcntl.LOCK_EX)
+            code, out, err = self.t.runError("--daemon --socket " + path)
+        self.assertIn("already listening", out)
+        self.assertFalse(os.path.exists(path))
+
+    def test_daemon_already_listening(self):
+        """Test that a live daemon is never displaced"""
+        code, out, err = self.t.runError("--daemon --socket " + self.socket)
+        self.assertIn("already listening", out)
+        code, out, err = self.t("--connect --socket " + self.socket,
+                                input="a foo\n".encode())
+        self.assertEqual('\x1b[31ma foo\x1b[0m\n', out)
+
+    def test_client_lost_daemon(self):
+        """Test that a client fails when the daemon goes away mid-stream"""
+        client = Popen([self.t.clog, "-f", self.t.clogrc,
+                        "--connect", "--socket", self.socket],
+                       stdin=PIPE, stdout=PIPE, stderr=PIPE)
+        client.stdin.write(b"a foo\n")
+        client.stdin.flush()
+        time.sleep(0.2)
+        self.daemon.terminate()
+        self.daemon.wait()
+        out, err = client.communicate(timeout=5)
+        self.assertNotEqual(0, client.returncode)
+        self.assertIn(b"Lost the connection", out)
+
+    def test_daemon_removes_socket(self):
+        """Test that the daemon removes its socket on termination"""
+        self.daemon.terminate()
+        self.daemon.wait()
+        self.assertFalse(os.path.exists(self.socket))
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
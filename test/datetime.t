@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestDatetime(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+
+    def test_datetime(self):
+        """Test coloring the timestamp of every line"""
+        self.t.config('default rule "" --> red datetime')
+
+        code, out, err = self.t("", input='2017-06-25T14:03:11Z a\nb\n'.encode())
+        self.assertEqual('\x1b[31m2017-06-25T14:03:11Z\x1b[0m a\nb\n', out)
+
+    def test_time(self):
+        """Test coloring only the time of day of a syslog timestamp"""
+        self.t.config('default rule "" --> blue time')
+
+        code, out, err = self.t("", input='Jun  5 14:03:11 host sshd\n'.encode())
+        self.assertEqual('Jun  5 \x1b[34m14:03:11\x1b[0m host sshd\n', out)
+
+    def test_datetime_pattern(self):
+        """Test coloring the timestamp only of lines matching the pattern"""
+        self.t.config('default rule /GET/ --> green datetime')
+
+        data = '1.2.3.4 - - [25/Jun/2017:14:03:11 +0200] "GET /"\n' \
+               '1.2.3.4 - - [25/Jun/2017:14:03:12 +0200] "PUT /"\n'
+        code, out, err = self.t("", input=data.encode())
+        self.assertIn('[\x1b[32m25/Jun/2017:14:03:11 +0200\x1b[0m] "GET /"\n', out)
+        self.assertIn('[25/Jun/2017:14:03:12 +0200] "PUT /"\n', out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Filter.h>
+#include <Input.h>
+#include <test.h>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+// Every allocation made through operator new is counted while enabled.
+static bool counting    = false;
+static int  allocations = 0;
+
+void* operator new (std::size_t size)
+{
+  if (counting)
+    ++allocations;
+
+  if (void* p = malloc (size ? size : 1))
+    return p;
+
+  throw std::bad_alloc ();
+}
+
+void operator delete (void* p) noexcept
+{
+  free (p);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Applies every rule in file order, as clog always did, until a final rule
+// hits, for comparison.
+static std::string reference (
+  std::vector <Rule>& rules,
+  const std::string& line)
+{
+  Layers layers;
+  Rule::Scratch scratch;
+  bool blanks = false;
+  layers.add (0, line.length (), {0});
+  for (auto& rule : rules)
+    if (rule._section == "default" &&
+        rule.apply (scratch, layers, blanks, line) &&
+        rule._final)
+      break;
+
+  std::string output;
+  if (blanks)
+    output += '\n';
+
+  if (layers.width () || line.length () == 0)
+  {
+    layers.render (line, output);
+    output += '\n';
+  }
+
+  if (blanks)
+    output += '\n';
+
+  return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Rules in arbitrary order, where the most frequent hits come last.
+static void testReordering (UnitTest& t)
+{
+  std::vector <Rule> rules;
+  for (int i = 0; i < 20; ++i)
+    rules.push_back (Rule ("default rule \"never" + std::to_string (i) + "\" --> suppress"));
+
+  rules.push_back (Rule ("default rule \"z\"   --> blank"));
+  rules.push_back (Rule ("default rule /[0-9]7/ --> suppress"));
+  rules.push_back (Rule ("default rule \"1\"   --> suppress"));
+  rules.push_back (Rule ("default rule \"4\"   --> blank final"));
+  rules.push_back (Rule ("default rule \"3\"   --> red line"));
+  rules.push_back (Rule ("default rule \"9\"   --> green match stop"));
+  rules.push_back (Rule ("default rule \"5\"   --> suppress"));
+  rules.push_back (Rule ("default rule \"x\"   --> blank"));
+  rules.push_back (Rule ("default rule \"2\"   --> suppress"));
+
+  std::vector <Rule> copies (rules);
+  Filter filter (rules, {});
+
+  bool same = true;
+  std::string output;
+  for (int i = 0; i < 50000 && same; ++i)
+  {
+    auto line = std::to_string (i * 7919 % 100000) + (i % 3 ? " x" : " z");
+    output.clear ();
+    filter.apply (line, output);
+    same = output == reference (copies, line);
+  }
+
+  t.ok (same, "Filter: reordered rules produce identical output");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (5);
+
+  testReordering (t);
+
+  std::vector <Rule> rules;
+  rules.push_back (Rule ("default rule /warn|debug/  --> yellow line"));
+  rules.push_back (Rule ("default rule /code:(5..)/  --> red match"));
+  rules.push_back (Rule ("default rule \"error\"     --> bold red match"));
+  rules.push_back (Rule ("default rule \"ignore\"    --> suppress"));
+  rules.push_back (Rule ("default rule \"critical\"  --> blank"));
+  rules.push_back (Rule ("other   rule \"foo\"       --> blue line"));
+
+  Filter filter (rules, {"default", "other"});
+
+  // Lines of varying length and rule hits, written to a file for Input.
+  const char* samples[] =
+  {
+    "plain line with nothing of interest",
+    "warn: a warning, code:503 and an error, another error",
+    "debug: ignore this one",
+    "critical: foo is broken",
+    "",
+    "a much longer line that matches nothing, but is long enough to need more room than the others do, code:200",
+  };
+
+  char path[] = "/tmp/filter.t.XXXXXX";
+  int fd = mkstemp (path);
+  FILE* file = fdopen (fd, "w");
+  for (int i = 0; i < 20000; ++i)
+    fprintf (file, "%s\n", samples[i % 6]);
+  fclose (file);
+
+  Input input;
+  input.open (path);
+  unlink (path);
+
+  // Warm up, so that all buffers reach their steady state capacity.
+  std::string line;
+  std::string output;
+  std::vector <std::string> expected (6);
+  for (int i = 0; i < 3000; ++i)
+  {
+    input.getline (line);
+    output.clear ();
+    filter.apply (line, output);
+    expected[i % 6] = output;
+  }
+
+  int lines = 0;
+  bool same = true;
+  counting = true;
+  while (input.getline (line))
+  {
+    output.clear ();
+    filter.apply (line, output);
+    same = same && output == expected[lines % 6];
+    ++lines;
+  }
+  counting = false;
+
+  t.is (lines, 20000 - 3000,    "Input: all lines read");
+  t.ok (same,                    "Filter: all lines rendered consistently");
+  t.is (allocations, 0,          "Filter: no allocations in steady state");
+  t.is (expected[2], "",         "Filter: suppressed line");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestFinal(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "error" --> red line final')
+        self.t.config('default rule "warn"  --> yellow line stop')
+        self.t.config('default rule "e"     --> blue match')
+        self.t.config('default rule "debug" --> suppress')
+
+    def test_final_stops(self):
+        """Test that no rule is applied after a final rule hits"""
+        code, out, err = self.t("", input='error debug\n'.encode())
+        self.assertEqual('\x1b[31merror debug\x1b[0m\n', out)
+
+    def test_stop_stops(self):
+        """Test that 'stop' is the same as 'final'"""
+        code, out, err = self.t("", input='warn debug\n'.encode())
+        self.assertEqual('\x1b[33mwarn debug\x1b[0m\n', out)
+
+    def test_final_misses(self):
+        """Test that later rules apply when a final rule does not hit"""
+        code, out, err = self.t("", input='one\nmore debug\n'.encode())
+        self.assertEqual('on\x1b[34me\x1b[0m\n', out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
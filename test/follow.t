@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import time
+import select
+import platform
+import unittest
+from subprocess import Popen, PIPE
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+@unittest.skipIf(platform.system() != "Linux", "Follow mode requires inotify")
+class TestFollow(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red line')
+        self.t.config('other   rule "foo" --> blue line')
+        self.one = os.path.join(self.t.datadir, "one.log")
+        self.two = os.path.join(self.t.datadir, "two.log")
+        self.three = os.path.join(self.t.datadir, "three:3.log")
+        with open(self.one, "w") as f:
+            f.write("old foo\n")
+        with open(self.two, "w") as f:
+            f.write("old foo\n")
+        with open(self.three, "w") as f:
+            f.write("old foo\n")
+        self.p = Popen([self.t.clog, "-f", self.t.clogrc,
+                        "--follow", self.one,
+                        "--follow", self.two + ":other:two",
+                        "--follow", self.three + ":other:three"],
+                       stdout=PIPE, stderr=PIPE)
+        time.sleep(0.3)
+
+    def tearDown(self):
+        """Executed after each test in the class"""
+        self.p.kill()
+        self.p.wait()
+
+    def append(self, path, text):
+        with open(path, "a") as f:
+            f.write(text)
+
+    def read(self, expected_lines, timeout=3):
+        out = b""
+        end = time.time() + timeout
+        while out.count(b"\n") < expected_lines and time.time() < end:
+            ready, _, _ = select.select([self.p.stdout], [], [], 0.1)
+            if ready:
+                out += os.read(self.p.stdout.fileno(), 65536)
+        return out.decode()
+
+    def test_follow_appends(self):
+        """Test that only appended lines are filtered, per-file sections and tags"""
+        self.append(self.one, "a foo\n")
+        self.assertEqual('\x1b[31ma foo\x1b[0m\n', self.read(1))
+        self.append(self.two, "b foo\nb bar\n")
+        self.assertEqual('two \x1b[34mb foo\x1b[0m\ntwo b bar\n', self.read(2))
+
+    def test_follow_colon_in_path(self):
+        """Test that a file name may hold a colon"""
+        self.append(self.three, "c foo\n")
+        self.assertEqual('three \x1b[34mc foo\x1b[0m\n', self.read(1))
+
+    def test_follow_twice(self):
+        """Test that one file cannot be followed twice"""
+        code, out, err = self.t.runError("--follow %s --follow %s:other:again" % (self.one, self.one))
+        self.assertIn("Cannot follow %s more than once." % self.one, out)
+
+    def test_follow_partial_line(self):
+        """Test that a line is only emitted once complete"""
+        self.append(self.one, "par")
+        self.assertEqual('', self.read(1, timeout=0.5))
+        self.append(self.one, "tial\n")
+        self.assertEqual('partial\n', self.read(1))
+
+    def test_follow_rotation(self):
+        """Test that a rotated file is followed at its path"""
+        self.append(self.one, "before\n")
+        self.assertEqual('before\n', self.read(1))
+        os.rename(self.one, self.one + ".1")
+        self.append(self.one, "after\n")
+        self.assertEqual('after\n', self.read(1))
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Histogram.h>
+#include <test.h>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (14);
+
+  // Buckets are exact below 16, then sixteen to each power of two.
+  t.is ((int) Histogram::bucket (0),         0,   "bucket 0");
+  t.is ((int) Histogram::bucket (15),        15,  "bucket 15");
+  t.is ((int) Histogram::bucket (16),        16,  "bucket 16");
+  t.is ((int) Histogram::bucket (31),        31,  "bucket 31");
+  t.is ((int) Histogram::bucket (32),        32,  "bucket 32");
+  t.is ((int) Histogram::bucket (33),        32,  "bucket 33 shares with 32");
+  t.is ((int) Histogram::lowest (33),        34,  "lowest of bucket 33");
+  t.ok (Histogram::bucket (~0ULL) < 976,         "bucket of the largest value");
+
+  Histogram empty;
+  t.ok (empty.quantile (0.5) == 0,               "empty quantile");
+
+  // 1000 values of 1us, ten of 1ms, one of 1s.
+  Histogram h;
+  for (int i = 0; i < 1000; ++i)
+    h.record (1000);
+  for (int i = 0; i < 10; ++i)
+    h.record (1000000);
+  h.record (1000000000);
+
+  t.ok (h.count () == 1011,                      "count");
+  t.ok (h.quantile (0.5) >= 1000 && h.quantile (0.5) < 1064,
+                                                 "p50 within the bucket of 1us");
+  t.ok (h.quantile (0.999) >= 1000000 && h.quantile (0.999) < 1065536,
+                                                 "p99.9 within the bucket of 1ms");
+  t.ok (h.max () == 1000000000,                  "max is exact");
+
+  char buffer[256];
+  auto length = h.format (buffer, sizeof (buffer));
+  t.is (std::string (buffer, length),
+        "lines 1011, p50 1.0us, p99 1015.8us, p99.9 1015.8us, max 1000000.0us\n",
+        "format");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <History.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (9);
+
+  History history;
+  history.add ("lost", true);
+  t.ok (history.size () == 0,                       "no capacity holds nothing");
+
+  history.resize (3);
+  history.add ("one", true);
+  history.add ("two", false);
+  t.ok (history.size () == 2,                       "holds two lines");
+  t.is (*history.hidden (0), "one",                 "oldest first");
+  t.ok (history.hidden (1) == nullptr,              "shown line is not held");
+
+  history.add ("three", true);
+  history.add ("four", true);
+  t.ok (history.size () == 3,                       "holds at most three");
+  t.ok (history.hidden (0) == nullptr,              "oldest dropped");
+  t.is (*history.hidden (1), "three",               "then three");
+  t.is (*history.hidden (2), "four",                "then four");
+
+  history.clear ();
+  t.ok (history.size () == 0,                       "cleared");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import gzip
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestIndex(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red line')
+        self.t.config('default rule "rare" --> blue match')
+        self.path = os.path.join(self.t.datadir, "input.log")
+        with open(self.path, "w") as f:
+            for i in range(50000):
+                f.write("line {0} foo\n".format(i) if i != 30000 else "line {0} rare\n".format(i))
+
+    def test_only(self):
+        """Test showing only lines hit by a rule, without an index"""
+        code, out, err = self.t("--only 2 -i " + self.path)
+        self.assertEqual("line 30000 \x1b[34mrare\x1b[0m\n", out)
+
+    def test_only_indexed(self):
+        """Test that an index gives the same output"""
+        code, out, err = self.t("--build-index -i " + self.path)
+        self.assertIn("Indexed " + self.path, out)
+        self.assertTrue(os.path.exists(self.path + ".clogidx"))
+
+        code, out, err = self.t("--only 2 -i " + self.path)
+        self.assertEqual("line 30000 \x1b[34mrare\x1b[0m\n", out)
+
+        code, out, err = self.t("--only 1,2 -i " + self.path)
+        self.assertEqual(50000, out.count("\n"))
+
+    def test_stale_file(self):
+        """Test that an index is ignored once the file changes"""
+        self.t("--build-index -i " + self.path)
+        with open(self.path, "a") as f:
+            f.write("appended rare\n")
+
+        code, out, err = self.t("--only 2 -i " + self.path)
+        self.assertEqual("line 30000 \x1b[34mrare\x1b[0m\nappended \x1b[34mrare\x1b[0m\n", out)
+
+    def test_stale_rules(self):
+        """Test that an index is ignored once the rules change"""
+        self.t("--build-index -i " + self.path)
+        self.t.config('default rule "line 4" --> green line')
+
+        code, out, err = self.t("--only 3 -i " + self.path)
+        self.assertEqual(11111, out.count("\n"))
+
+    def test_max_line(self):
+        """Test that an index sees a long line as split by --max-line"""
+        self.t.config('default rule /a$/ --> green line')
+        with open(self.path, "a") as f:
+            f.write("a" * 200 + " tail\n")
+
+        code, plain, err = self.t("--max-line 100 --only 3 -i " + self.path)
+        self.assertEqual(1, plain.count("\n"))
+
+        self.t("--max-line 100 --build-index -i " + self.path)
+        code, out, err = self.t("--max-line 100 --only 3 -i " + self.path)
+        self.assertEqual(plain, out)
+
+    def test_stale_max_line(self):
+        """Test that an index is ignored under a different --max-line"""
+        self.t.config('default rule /a$/ --> green line')
+        with open(self.path, "a") as f:
+            f.write("a" * 200 + " tail\n")
+
+        self.t("--build-index -i " + self.path)
+        code, out, err = self.t("--max-line 100 --only 3 -i " + self.path)
+        self.assertEqual(1, out.count("\n"))
+
+    def test_unknown_rule(self):
+        """Test that an unknown rule number is an error"""
+        code, out, err = self.t.runError("--only 3 -i " + self.path)
+        self.assertIn("There is no rule 3.", out)
+
+    def test_compressed(self):
+        """Test that a compressed file cannot be indexed"""
+        path = self.path + ".gz"
+        with open(path, "wb") as f:
+            f.write(gzip.compress(b"foo\n"))
+
+        code, out, err = self.t.runError("--build-index -i " + path)
+        self.assertIn("which is compressed", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import re
+import sys
+import time
+import select
+import signal
+import unittest
+from subprocess import Popen, PIPE
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+REPORT = r"clog: lines {}, p50 \d+\.\dus, p99 \d+\.\dus, p99\.9 \d+\.\dus, max \d+\.\dus\n" \
+         r"clog: queued \d+KiB, high \d+KiB, budget {}KiB\n"
+
+
+class TestLatency(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red match')
+
+    def test_stats_at_exit(self):
+        """Test that the latency is reported on stderr at exit"""
+        code, out, err = self.t("--stats", input="foo\nbar\nbaz\n".encode())
+        self.assertEqual('\x1b[31mfoo\x1b[0m\nbar\nbaz\n', out)
+        self.assertRegex(err, REPORT.format(3, 16384))
+
+    def test_no_stats(self):
+        """Test that nothing is reported without --stats"""
+        code, out, err = self.t("", input="foo\n".encode())
+        self.assertEqual("", err)
+
+    def test_stats_on_signal(self):
+        """Test that SIGUSR1 reports the latency while waiting for input"""
+        p = Popen([self.t.clog, "-f", self.t.clogrc, "--stats"],
+                  stdin=PIPE, stdout=PIPE, stderr=PIPE)
+        p.stdin.write(b"foo\nbar\n")
+        p.stdin.flush()
+        time.sleep(0.3)
+        p.send_signal(signal.SIGUSR1)
+
+        err = b""
+        end = time.time() + 3
+        while b"\n" not in err and time.time() < end:
+            ready, _, _ = select.select([p.stderr], [], [], 0.1)
+            if ready:
+                err += os.read(p.stderr.fileno(), 65536)
+
+        p.stdin.close()
+        p.wait()
+        self.assertRegex(err.decode(), "^" + REPORT.format(2, 16384) + "$")
+        # The first line, read before the reading thread started, is timed too.
+        peak = float(re.search(r"max (\d+\.\d)us", err.decode()).group(1))
+        self.assertLess(peak, 1000000)
+
+    def test_read_ahead(self):
+        """Test that a pipe is read ahead while the output is stalled"""
+        p = Popen([self.t.clog, "-f", self.t.clogrc, "--buffer", "4M"],
+                  stdin=PIPE, stdout=PIPE, stderr=PIPE)
+
+        # Nothing reads clog's output, so it stalls once the pipe is full, but
+        # its input is still drained into the read-ahead buffer.
+        line = b"foo " + b"x" * 1019 + b"\n"
+        written = 0
+        os.set_blocking(p.stdin.fileno(), False)
+        end = time.time() + 3
+        while written < 2 << 20 and time.time() < end:
+            try:
+                written += os.write(p.stdin.fileno(), line * 64)
+            except BlockingIOError:
+                time.sleep(0.01)
+
+        p.kill()
+        p.wait()
+        self.assertGreaterEqual(written, 2 << 20)
+
+    def test_buffer_invalid(self):
+        """Test that an unrecognized size is an error"""
+        code, out, err = self.t.runError("--buffer 4X")
+        self.assertIn("Cannot parse size '4X'.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
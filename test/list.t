@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestList(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.noise = os.path.join(self.t.datadir, "noise.txt")
+        with open(self.noise, "w") as f:
+            for i in range(10000):
+                f.write("heartbeat %d ok\n" % i)
+
+        self.users = os.path.join(self.t.datadir, "users.txt")
+        with open(self.users, "w") as f:
+            f.write("alice\nbob\r\n\n")
+
+    def test_lines_suppress(self):
+        """Test suppressing lines found in a list"""
+        self.t.config('default rule lines %s --> suppress' % self.noise)
+        code, out, err = self.t("", input="heartbeat 17 ok\nheartbeat 17 failed\nheartbeat 9999 ok\n".encode())
+        self.assertEqual("heartbeat 17 failed\n", out)
+
+    def test_tokens_match(self):
+        """Test coloring the tokens found in a list"""
+        self.t.config('default rule tokens %s --> red match' % self.users)
+        code, out, err = self.t("", input="login bob\tfrom alice, bobby\n".encode())
+        self.assertEqual("login \x1b[31mbob\x1b[0m\tfrom alice, bobby\n", out)
+
+    def test_tokens_line(self):
+        """Test coloring the lines that hold a token found in a list"""
+        self.t.config('default rule tokens %s --> blue line' % self.users)
+        code, out, err = self.t("", input="bob\ncarol\n".encode())
+        self.assertEqual("\x1b[34mbob\x1b[0m\ncarol\n", out)
+
+    def test_missing_list(self):
+        """Test that a list that cannot be read is an error"""
+        self.t.config('default rule lines /no/such/list --> suppress')
+        code, out, err = self.t.runError("", input="x\n".encode())
+        self.assertIn("Cannot open list /no/such/list.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestLongLines(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red match')
+
+    def test_split_unchanged(self):
+        """Test that a split line is output once, unchanged"""
+        data = "x" * 5000 + "\nshort\n"
+        code, out, err = self.t("--max-line 1000", input=data.encode())
+        self.assertEqual(data, out)
+
+    def test_split_boundary(self):
+        """Test that a match across a segment boundary is colored"""
+        code, out, err = self.t("--max-line 2048", input=("x" * 2046 + "foo" + "y" * 10 + "\n").encode())
+        self.assertEqual("x" * 2046 + "\x1b[31mfoo\x1b[0m" + "y" * 10 + "\n", out)
+
+    def test_truncate(self):
+        """Test that --truncate keeps the start of a long line, and a marker"""
+        code, out, err = self.t("--max-line 10 --truncate", input=("foo" + "x" * 20 + "\nshort\n").encode())
+        self.assertEqual("\x1b[31mfoo\x1b[0mxxxxxxx [13 bytes truncated]\nshort\n", out)
+
+    def test_exactly_the_limit(self):
+        """Test that a line of exactly --max-line bytes is neither truncated nor split"""
+        data = "foo" + "x" * 7 + "\nshort\n"
+        expected = "\x1b[31mfoo\x1b[0m" + "x" * 7 + "\nshort\n"
+        code, out, err = self.t("--max-line 10 --truncate", input=data.encode())
+        self.assertEqual(expected, out)
+        code, out, err = self.t("--max-line 10", input=data.encode())
+        self.assertEqual(expected, out)
+
+    def test_unlimited(self):
+        """Test that --max-line 0 removes the limit"""
+        data = "foo" + "x" * 100 + "\n"
+        code, out, err = self.t("--max-line 0 --truncate", input=data.encode())
+        self.assertEqual("\x1b[31mfoo\x1b[0m" + "x" * 100 + "\n", out)
+
+    def test_max_line_suffix(self):
+        """Test that --max-line takes a K, M or G suffix"""
+        data = "foo" + "x" * 2000 + "\n"
+        code, out, err = self.t("--max-line 1K --truncate", input=data.encode())
+        self.assertEqual("\x1b[31mfoo\x1b[0m" + "x" * 1021 + " [979 bytes truncated]\n", out)
+
+    def test_invalid_max_line(self):
+        """Test that an invalid --max-line is an error, not unlimited"""
+        code, out, err = self.t.runError("--max-line abc", input="foo\n".encode())
+        self.assertIn("Cannot parse size 'abc'.", out)
+
+    def test_overlapping_matches(self):
+        """Test that overlapping matches are colored as one span"""
+        self.t.config('default rule "aa" --> blue match')
+        code, out, err = self.t("", input="baaaab\n".encode())
+        self.assertEqual("b\x1b[34maaaa\x1b[0mb\n", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
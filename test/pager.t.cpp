@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Pager.h>
+#include <test.h>
+#include <cstdlib>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string temporary (const std::string& content)
+{
+  char path[] = "/tmp/pager.t.XXXXXX";
+  int fd = mkstemp (path);
+  auto written = write (fd, content.data (), content.length ());
+  (void) written;
+  close (fd);
+  return path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (25);
+
+  std::vector <Rule> rules {Rule ("default rule \"two\" --> red line"),
+                            Rule ("default rule \"three\" --> suppress"),
+                            Rule ("default rule \"four\" --> blank"),
+                            Rule ("default rule \"five\" --> red line context=2")};
+
+  // one\n two\n three\n four\n, at offsets 0, 4, 8, 14.
+  auto path = temporary ("one\ntwo\nthree\nfour\n");
+  {
+    Pager pager (rules, {});
+    pager.open (path);
+    t.ok (pager.size () == 19,                     "size");
+    t.ok (pager.next (0) == 4,                     "next line");
+    t.ok (pager.next (14) == 19,                   "next of last line is the end");
+    t.ok (pager.previous (8) == 4,                 "previous line");
+    t.ok (pager.previous (4) == 0,                 "previous of second line");
+    t.ok (pager.previous (19) == 14,               "previous of the end is the last line");
+
+    t.is (pager.render (0), "one\n",               "plain line rendered");
+    t.ok (pager.render (4) != "two\n",             "colored line rendered");
+    t.ok (pager.rows (8) == 0,                     "suppressed line has no rows");
+    t.ok (pager.rows (14) == 3,                    "blank rule adds rows");
+
+    pager.wait ();
+    std::size_t lines = 0;
+    t.ok (pager.indexed (lines) && lines == 4,     "indexed 4 lines");
+    std::size_t number = 0;
+    t.ok (pager.number (8, number) && number == 3, "offset 8 is line 3");
+    t.ok (pager.seek (2) == 4,                     "line 2 is at offset 4");
+    t.ok (pager.seek (99) == 14,                   "beyond the end is the last line");
+
+    pager.search ({0});
+    t.ok (pager.find (0, true) == 4,               "search forward");
+    t.ok (pager.find (4, true) == std::string::npos, "no more hits forward");
+    t.ok (pager.find (14, false) == 4,             "search backward");
+
+    // Rows: one, two, (blank), four, (blank).
+    pager.height (2);
+    pager.top (0, 0);
+    pager.down (1);
+    t.ok (pager.top () == 4,                       "down a row");
+    pager.down (1);
+    t.ok (pager.top () == 14,                      "down skips a suppressed line");
+    pager.up (1);
+    t.ok (pager.top () == 4,                       "up skips a suppressed line");
+    pager.end ();
+    t.ok (pager.top () == 14,                      "end shows the last screen");
+  }
+
+  t.ok (rules[3]._around == 2,                     "rules keep their context");
+
+  unlink (path.c_str ());
+
+  // Many lines, so that numbers come from an index entry.
+  std::string content;
+  for (int i = 1; i <= 1000; ++i)
+    content += std::to_string (i) + '\n';
+
+  path = temporary (content);
+  {
+    Pager pager (rules, {});
+    pager.open (path);
+    pager.wait ();
+    auto offset = pager.seek (700);
+    t.is (pager.render (offset), "700\n",          "seek to line 700");
+    std::size_t number = 0;
+    t.ok (pager.number (offset, number) && number == 700, "line 700 numbered");
+    pager.height (10);
+    pager.end ();
+    t.is (pager.render (pager.top ()), "991\n",    "end shows the last ten lines");
+  }
+
+  unlink (path.c_str ());
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
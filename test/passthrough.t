@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestPassthrough(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red match')
+        self.t.config('default rule "bar" --> suppress')
+
+    def test_interleaved(self):
+        """Test that untouched lines keep their place among rendered ones"""
+        lines = []
+        expected = []
+        for i in range(20000):
+            if i % 7 == 0:
+                lines.append("line %d foo" % i)
+                expected.append("line %d \x1b[31mfoo\x1b[0m" % i)
+            elif i % 11 == 0:
+                lines.append("line %d bar" % i)
+            else:
+                lines.append("line %d" % i)
+                expected.append("line %d" % i)
+
+        data = "\n".join(lines) + "\n"
+        code, out, err = self.t("", input=data.encode())
+        self.assertEqual("\n".join(expected) + "\n", out)
+
+    def test_unterminated(self):
+        """Test that an untouched last line without \\n is terminated"""
+        code, out, err = self.t("", input="one\ntwo".encode())
+        self.assertEqual("one\ntwo\n", out)
+
+    def test_empty_lines(self):
+        """Test that empty lines pass through"""
+        code, out, err = self.t("", input="\n\nfoo\n\n".encode())
+        self.assertEqual("\n\n\x1b[31mfoo\x1b[0m\n\n", out)
+
+    def test_decorated(self):
+        """Test that decorated lines are not passed through"""
+        code, out, err = self.t("--time", input="one\n".encode())
+        self.assertRegex(out, r'^\d{2}:\d{2}:\d{2} one\n$')
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
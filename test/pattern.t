@@ -64,6 +64,33 @@ class TestPatternMatch(TestCase):
         self.assertRegex(out, r'\na bar\n')
         self.assertRegex(out, r'\na baz\n')
 
+class TestPatternCase(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+
+    def test_pattern_case_sensitive(self):
+        """Test that a pattern is case-sensitive by default"""
+        self.t.config('default rule "foo" --> red match')
+
+        code, out, err = self.t("", input='a FOO\n'.encode())
+        self.assertEqual('a FOO\n', out)
+
+    def test_pattern_case_insensitive(self):
+        """Test matching a pattern with the i flag, ignoring case"""
+        self.t.config('default rule "fOo"i --> red match')
+
+        code, out, err = self.t("", input='a Foo foo FOO fo\n'.encode())
+        self.assertEqual('a \x1b[31mFoo\x1b[0m \x1b[31mfoo\x1b[0m \x1b[31mFOO\x1b[0m fo\n', out)
+
+    def test_pattern_case_insensitive_long(self):
+        """Test matching a pattern with the i flag, in a long line"""
+        self.t.config('default rule "error: disk"i --> red line')
+
+        code, out, err = self.t("", input=('x' * 100 + 'ERROR: Disk full\n' + 'x' * 100 + 'error: disc\n').encode())
+        self.assertIn('\x1b[31m' + 'x' * 100 + 'ERROR: Disk full\x1b[0m\n', out)
+        self.assertIn('\n' + 'x' * 100 + 'error: disc\n', out)
+
 class TestPatternOverlap(TestCase):
     def setUp(self):
         """Executed before each test in the class"""
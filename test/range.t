@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestTimeRange(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red line')
+        self.data = "".join("2017-06-25T{0:02d}:00:00 line {0}\n  more {0}\n".format(hour)
+                            for hour in range(24))
+        self.path = os.path.join(self.t.datadir, "input.log")
+        with open(self.path, "w") as f:
+            f.write(self.data)
+
+    def expected(self, first, last):
+        return "".join("2017-06-25T{0:02d}:00:00 line {0}\n  more {0}\n".format(hour)
+                       for hour in range(first, last))
+
+    def test_range_stdin(self):
+        """Test --since and --until on stdin"""
+        code, out, err = self.t("--since 2017-06-25T05:00 --until '2017-06-25 08:00'", input=self.data.encode())
+        self.assertEqual(self.expected(5, 8), out)
+
+    def test_range_file(self):
+        """Test --since and --until on a file, searched for the window"""
+        code, out, err = self.t("--since 2017-06-25T05:30 --until 2017-06-25T08:00:00 -i " + self.path)
+        self.assertEqual(self.expected(6, 8), out)
+
+    def test_range_files(self):
+        """Test that each file is searched for the window"""
+        code, out, err = self.t("--since 2017-06-25T22:00 -i {0} -i {0}".format(self.path))
+        self.assertEqual(self.expected(22, 24) * 2, out)
+
+    def test_range_date(self):
+        """Test that a date alone means midnight"""
+        code, out, err = self.t("--until 2017-06-25 -i " + self.path)
+        self.assertEqual("", out)
+        code, out, err = self.t("--since 2017-06-25 -i " + self.path)
+        self.assertEqual(self.data, out)
+
+    def test_range_untimed(self):
+        """Test that lines before the first timestamp are kept only without --since"""
+        data = "header\n" + self.data
+        code, out, err = self.t("--until 2017-06-25T01:00", input=data.encode())
+        self.assertEqual("header\n" + self.expected(0, 1), out)
+        code, out, err = self.t("--since 2017-06-25T23:00", input=data.encode())
+        self.assertEqual(self.expected(23, 24), out)
+
+    def test_range_invalid(self):
+        """Test that an unrecognized time is an error"""
+        code, out, err = self.t.runError("--since yesterday")
+        self.assertIn("Cannot parse time 'yesterday'.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
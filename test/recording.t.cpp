@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Recording.h>
+#include <test.h>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (23);
+
+  char out[20];
+  const char* cursor = out;
+  std::uint64_t value;
+  t.ok (Recording::encode (out, 127) == 1,                     "127 takes one byte");
+  t.ok (Recording::encode (out, 300) == 2,                     "300 takes two bytes");
+  t.ok (Recording::decode (cursor, out + 2, value) && value == 300, "300 decoded");
+  cursor = out;
+  t.notok (Recording::decode (cursor, out + 1, value),         "cut short");
+
+  std::string path = "recording.t." + std::to_string (getpid ());
+  auto start = std::chrono::steady_clock::now ();
+  {
+    Recording recording;
+    recording.create (path);
+    recording.add ("first", 0, std::string::npos, start);
+    recording.add ("long seg", 0, 4, start + std::chrono::milliseconds (5));
+    recording.add ("long segment", 4, std::string::npos, start + std::chrono::milliseconds (6));
+    recording.add ("", 0, std::string::npos, start + std::chrono::seconds (2));
+  }
+
+  Recording recording;
+  recording.open (path);
+  const char* line;
+  std::size_t length;
+  bool last;
+  t.ok (recording.next (value, line, length, last),            "first line");
+  t.ok (value == 0,                                            "first has no delay");
+  t.is (std::string (line, length), "first",                   "first text");
+  t.ok (last,                                                  "first is whole");
+  t.ok (recording.next (value, line, length, last),            "second line");
+  t.ok (value == 5000,                                         "delay from the first segment");
+  t.is (std::string (line, length), "long",                    "first segment");
+  t.notok (last,                                               "first segment continues");
+  t.ok (recording.next (value, line, length, last),            "second segment");
+  t.ok (value == 0,                                            "second segment has no delay");
+  t.is (std::string (line, length), " segment",                "second segment without overlap");
+  t.ok (last,                                                  "second segment ends the line");
+  t.ok (recording.next (value, line, length, last),            "third line");
+  t.ok (value == 1995000,                                      "delay in microseconds");
+  t.ok (length == 0,                                           "empty line");
+  t.notok (recording.next (value, line, length, last),         "end");
+
+  unlink (path.c_str ());
+
+  try
+  {
+    Recording other;
+    other.open ("recording.t.cpp");
+    t.fail ("source is not a recording");
+  }
+  catch (const std::string& error)
+  {
+    t.ok (error.find ("which is not a recording") != std::string::npos, "source is not a recording");
+  }
+
+  try
+  {
+    Recording missing;
+    missing.open ("recording.t.missing");
+    t.fail ("missing file");
+  }
+  catch (const std::string& error)
+  {
+    t.ok (error.find ("Cannot open") == 0,                     "missing file");
+  }
+
+  try
+  {
+    Recording unwritable;
+    unwritable.create ("/nonexistent/recording");
+    t.fail ("unwritable file");
+  }
+  catch (const std::string& error)
+  {
+    t.ok (error.find ("Cannot open") == 0,                     "unwritable file");
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
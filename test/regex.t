@@ -64,6 +64,18 @@ class TestRegexMatch(TestCase):
         self.assertRegex(out, r'\na bar\n')
         self.assertRegex(out, r'\na baz\n')
 
+class TestRegexCase(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+
+    def test_regex_case_insensitive(self):
+        """Test matching a regex with the i flag, ignoring case"""
+        self.t.config('default rule /e+rr/i --> red match')
+
+        code, out, err = self.t("", input='an Error\nan ERR\nan eRr\nfine\n'.encode())
+        self.assertEqual('an \x1b[31mErr\x1b[0mor\nan \x1b[31mERR\x1b[0m\nan \x1b[31meRr\x1b[0m\nfine\n', out)
+
 if __name__ == "__main__":
     from simpletap import TAPTestRunner
     unittest.main(testRunner=TAPTestRunner())
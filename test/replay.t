@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from subprocess import Popen, PIPE
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+class TestReplay(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "error" --> red line')
+        self.recording = os.path.join(self.t.datadir, "input.rec")
+
+    def test_record_passes_through(self):
+        """Test that recording does not change the output"""
+        code, out, err = self.t("--record %s" % self.recording, input="one\ntwo error\n".encode())
+        self.assertEqual("one\n\x1b[31mtwo error\x1b[0m\n", out)
+        self.assertTrue(os.path.isfile(self.recording))
+
+    def test_replay_maximum_speed(self):
+        """Test replaying a recording as fast as clog reads it"""
+        self.t("--record %s" % self.recording, input="one\ntwo error\nthree\n".encode())
+        code, out, err = self.t("--replay %s --speed 0" % self.recording)
+        self.assertIn("replay: lines 3, bytes 20,", out)
+        self.assertIn(" at maximum speed\n", out)
+        self.assertIn("replay: output lines 3, bytes 29,", out)
+        self.assertRegex(out, r"replay: latency lines 3, p50 [0-9.]+us")
+
+    def test_replay_long_line(self):
+        """Test that a line recorded in segments is replayed whole"""
+        self.t("--max-line 16 --record %s" % self.recording, input=("x" * 100 + " error\none\n").encode())
+        code, out, err = self.t("--replay %s --speed 0" % self.recording)
+        self.assertIn("replay: lines 2, bytes 111,", out)
+        self.assertIn("replay: output lines 2, bytes 120,", out)
+
+    def test_replay_unresolvable_name(self):
+        """Test that replay runs the same clog, whatever name it was run by"""
+        self.t("--record %s" % self.recording, input="one\n".encode())
+        p = Popen(["clog-not-on-path", "-f", self.t.clogrc,
+                   "--replay", self.recording, "--speed", "0"],
+                  executable=self.t.clog, stdout=PIPE, stderr=PIPE)
+        out, err = p.communicate(timeout=10)
+        self.assertEqual(0, p.returncode)
+        self.assertIn(b"replay: output lines 1, bytes 4,", out)
+
+    def test_replay_paced(self):
+        """Test replaying a recording at a scaled pace"""
+        self.t("--record %s" % self.recording, input="one\ntwo\n".encode())
+        code, out, err = self.t("--replay %s --speed 2" % self.recording)
+        self.assertIn("replay: lines 2, bytes 8,", out)
+        self.assertIn(" at 2x\n", out)
+
+    def test_replay_suppressed(self):
+        """Test that suppressed lines are reported"""
+        self.t.config('default rule "two" --> suppress')
+        self.t("--record %s" % self.recording, input="one\ntwo\n".encode())
+        code, out, err = self.t("--replay %s --speed 0" % self.recording)
+        self.assertIn("replay: output lines 1, bytes 4, ", out)
+        self.assertIn(", 1 fewer than input\n", out)
+
+    def test_replay_not_a_recording(self):
+        """Test that only recordings are replayed"""
+        code, out, err = self.t.runError("--replay %s" % self.t.clogrc)
+        self.assertIn("which is not a recording.", out)
+
+    def test_replay_bad_speed(self):
+        """Test that a speed must be a positive number"""
+        code, out, err = self.t.runError("--replay %s --speed fast" % self.recording)
+        self.assertIn("Cannot parse speed 'fast'.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -42,7 +42,7 @@ void testRule (
     Rule r (line);
     t.ok (r._section  == section,  "<" + line + "> section match");
     t.ok (r._color    == color,    "<" + line + "> color match");
-    t.ok (r._context  == context,  "<" + line + "> context match");
+    t.ok (Rule::name (r._context) == context,  "<" + line + "> context match");
     t.ok (r._fragment == fragment, "<" + line + "> fragment match");
   }
   catch (...)
@@ -57,7 +57,7 @@ void testRule (
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (40);
+  UnitTest t (91);
 
   testRule (t, "default rule /bar/ --> suppress",     "default", {},       "suppress", "");
   testRule (t, "default rule /foo/ --> red line",     "default", {"red"},  "line",     "");
@@ -69,6 +69,60 @@ int main (int, char**)
   testRule (t, "default rule \"foo\" --> red line",   "default", {"red"},  "line",     "foo");
   testRule (t, "default rule \"foo\" --> red match",  "default", {"red"},  "match",    "foo");
   testRule (t, "default rule \"foo\" --> suppress",   "default", {},       "suppress", "foo");
+  testRule (t, "default rule /Err/i --> red line",    "default", {"red"},  "line",     "");
+  testRule (t, "default rule \"FoO\"i --> red match", "default", {"red"},  "match",    "foo");
+  testRule (t, "default rule /sshd/ --> red datetime", "default", {"red"}, "datetime", "");
+  testRule (t, "default rule \"sshd\" --> blue time", "default", {"blue"}, "time",     "sshd");
+  testRule (t, "default rule /foo/ --> red line final", "default", {"red"}, "line",   "");
+  testRule (t, "default rule \"foo\" --> stop suppress", "default", {},     "suppress", "foo");
+  testRule (t, "default rule \"took=\" >= 500 --> red match", "default", {"red"}, "match", "took=");
+
+  t.ok (Rule ("default rule /foo/ --> red line final")._final,  "final keyword");
+  t.ok (Rule ("default rule \"foo\" --> stop suppress")._final, "stop keyword");
+  t.notok (Rule ("default rule /foo/ --> red line")._final,     "not final by default");
+
+  Rule::Scratch scratch;
+  Rule keyed ("default rule \"took=\" >= 500 --> red match");
+  t.ok (keyed._matcher == Rule::Matcher::keyed,             "keyed threshold");
+  t.is (keyed._pattern, "\"took=\" >= 500",                 "keyed threshold written back");
+  t.ok (keyed.hits (scratch, "a took=12 took=500"),                 "keyed threshold hits any occurrence");
+  t.notok (keyed.hits (scratch, "a took=499.9"),                    "keyed threshold misses");
+
+  Rule field ("default rule field 2 != -1.5 --> line");
+  t.ok (field._matcher == Rule::Matcher::field,             "field threshold");
+  t.is (field._pattern, "field 2 != -1.5",                  "field threshold written back");
+  t.ok (field.hits (scratch, "a\t 2 -1.5"),                          "field threshold hits");
+  t.notok (field.hits (scratch, "a -1.5 2"),                         "field threshold misses");
+
+  Rule within ("default rule /ERROR/ within 0-10 --> red line");
+  t.ok (within._scope == Rule::Scope::within,               "within scope");
+  t.is (within._pattern, "/ERROR/ within 0-10",             "within scope written back");
+  t.ok (within.hits (scratch, "ts ERROR payload"),                   "within scope hits");
+  t.notok (within.hits (scratch, "0123456789 ERROR"),                "within scope misses after it");
+
+  Rule after ("default rule \"db\" after 2 \"|\" --> blue match");
+  t.is (after._pattern, "\"db\" after 2 \"|\"",            "after scope written back");
+  t.ok (after.hits (scratch, "a|b|db"),                              "after scope hits");
+  t.notok (after.hits (scratch, "db|a|b"),                           "after scope misses before it");
+  t.notok (after.hits (scratch, "a|db"),                             "after scope needs the delimiters");
+
+  Rule before ("default rule field 1 > 5 before 1 \"|\" --> line");
+  t.ok (before.hits (scratch, "9 a|1"),                              "before scope hits");
+  t.notok (before.hits (scratch, "1 a|9"),                           "before scope misses");
+
+  for (auto bad : {"default rule /x/ within 5-5 --> red",
+                   "default rule \"x\" after 0 \"|\" --> red"})
+  {
+    try
+    {
+      Rule r (bad);
+      t.fail (std::string (bad) + " rejected");
+    }
+    catch (int)
+    {
+      t.pass (std::string (bad) + " rejected");
+    }
+  }
 
   return 0;
 }
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+class TestScope(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+
+    def test_within_match(self):
+        """Test that a match within a byte range is colored where it is in the line"""
+        self.t.config('default rule "ERROR" within 0-10 --> red match')
+        code, out, err = self.t(input="ts ERROR x ERROR\n".encode())
+        self.assertEqual("ts \x1b[31mERROR\x1b[0m x ERROR\n", out)
+
+    def test_within_line(self):
+        """Test that a line action colors the whole line"""
+        self.t.config('default rule /^INFO/ within 4-20 --> red line')
+        code, out, err = self.t(input="001 INFO payload\nINFO payload\n".encode())
+        self.assertEqual("\x1b[31m001 INFO payload\x1b[0m\nINFO payload\n", out)
+
+    def test_after_delimiter(self):
+        """Test matching after the nth delimiter"""
+        self.t.config('default rule /[0-9]+/ after 2 "|" --> blue match')
+        code, out, err = self.t(input="1|2|345\n1|2\n".encode())
+        self.assertEqual("1|2|\x1b[34m345\x1b[0m\n1|2\n", out)
+
+    def test_before_delimiter(self):
+        """Test suppressing on the text before the nth delimiter"""
+        self.t.config('default rule "debug" before 1 " - " --> suppress')
+        code, out, err = self.t(input="app debug - ok\napp info - debug\n".encode())
+        self.assertEqual("app info - debug\n", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestSink(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red match')
+        self.t.config('default rule "debug" --> suppress')
+        self.t.config('default rule "bar" --> blank')
+        self.data = "a foo\nsome debug foo\nbar\nplain\n"
+
+    def read(self, name):
+        with open(os.path.join(self.t.datadir, name)) as f:
+            return f.read()
+
+    def test_sinks(self):
+        """Test that sinks in every mode are fed from one pass"""
+        ansi = os.path.join(self.t.datadir, "ansi.log")
+        plain = os.path.join(self.t.datadir, "plain.log")
+        routed = os.path.join(self.t.datadir, "routed.log")
+        code, out, err = self.t(["--sink", "ansi:" + ansi,
+                                 "--sink", "plain:" + plain,
+                                 "--sink", "rules=1,2:" + routed],
+                                input=self.data.encode())
+        self.assertEqual('a \x1b[31mfoo\x1b[0m\n\nbar\n\nplain\n', out)
+        self.assertEqual(out, self.read("ansi.log"))
+        self.assertEqual('a foo\n\nbar\n\nplain\n', self.read("plain.log"))
+        self.assertEqual('a foo\nsome debug foo\n', self.read("routed.log"))
+
+    def test_sink_appends(self):
+        """Test that a sink appends to its file"""
+        plain = os.path.join(self.t.datadir, "plain.log")
+        self.t(["--sink", "plain:" + plain], input="plain\n".encode())
+        self.t(["--sink", "plain:" + plain], input="plain\n".encode())
+        self.assertEqual('plain\nplain\n', self.read("plain.log"))
+
+    def test_sink_invalid(self):
+        """Test that an unrecognized sink is an error"""
+        code, out, err = self.t.runError("--sink color:x")
+        self.assertIn("Cannot parse sink 'color:x'.", out)
+
+    def test_sink_no_rule(self):
+        """Test that routing a rule that does not exist is an error"""
+        code, out, err = self.t.runError("--sink rules=7:x")
+        self.assertIn("There is no rule 7.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <StringSet.h>
+#include <test.h>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (9);
+
+  StringSet set;
+  t.notok (set.contains ("a", 1),                   "empty set contains nothing");
+
+  set.insert ("alpha", 5);
+  set.insert ("", 0);
+  set.insert ("alpha", 5);
+  t.ok (set.size () == 2,                           "duplicates are not added");
+  t.ok (set.contains ("alpha", 5),                  "contains alpha");
+  t.ok (set.contains ("", 0),                       "contains the empty string");
+  t.notok (set.contains ("alph", 4),                "no prefix");
+  t.ok (set.contains ("alphabet", 5),               "looked up by length");
+
+  // Many strings, to grow the table repeatedly.
+  for (int i = 0; i < 50000; ++i)
+  {
+    auto s = "entry " + std::to_string (i);
+    set.insert (s.data (), s.length ());
+  }
+
+  bool all = true;
+  for (int i = 0; i < 50000; ++i)
+  {
+    auto s = "entry " + std::to_string (i);
+    all = all && set.contains (s.data (), s.length ());
+  }
+
+  t.ok (all,                                        "contains every entry");
+  t.notok (set.contains ("entry 50000", 11),        "no other entry");
+
+  StringSet other;
+  other.insert ("", 0);
+  other.insert ("alpha", 5);
+  t.ok (other.fingerprint () != set.fingerprint (), "fingerprints differ");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+import os
+import sys
+import unittest
+
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+class TestSummary(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "foo" --> red match')
+        self.t.config('default rule /ba[rz]/ --> suppress')
+        self.t.config('other rule "foo" --> blue line')
+        self.data = "2017-06-25T14:00:10 foo\n" \
+                    "2017-06-25T14:00:20 foo bar\n" \
+                    "  continued baz\n" \
+                    "2017-06-25T14:01:30 nothing\n" \
+                    "2017-06-25T14:03:00 foo\n"
+
+    def test_summary(self):
+        """Test counting the lines hit by each rule"""
+        code, out, err = self.t("--summary", input=self.data.encode())
+        self.assertEqual("Rule  Section Action   Pattern  Hits\n"
+                         "    1 default match    \"foo\"       3\n"
+                         "    2 default suppress /ba[rz]/    2\n"
+                         "Lines                              5\n", out)
+
+    def test_summary_sections(self):
+        """Test that only the rules of the sections are counted"""
+        code, out, err = self.t("--summary other", input=self.data.encode())
+        self.assertIn("    3 other   line   \"foo\"      3\n", out)
+        self.assertNotIn("default", out)
+
+    def test_bucket_csv(self):
+        """Test counting per minute, as CSV"""
+        code, out, err = self.t("--bucket 1m --csv", input=self.data.encode())
+        self.assertEqual("time,lines,rule,section,action,pattern,hits\n"
+                         "2017-06-25 14:00:00,3,1,default,match,\"\"\"foo\"\"\",2\n"
+                         "2017-06-25 14:00:00,3,2,default,suppress,/ba[rz]/,2\n"
+                         "2017-06-25 14:01:00,1,1,default,match,\"\"\"foo\"\"\",0\n"
+                         "2017-06-25 14:01:00,1,2,default,suppress,/ba[rz]/,0\n"
+                         "2017-06-25 14:03:00,1,1,default,match,\"\"\"foo\"\"\",1\n"
+                         "2017-06-25 14:03:00,1,2,default,suppress,/ba[rz]/,0\n", out)
+
+    def test_bucket_invalid(self):
+        """Test that an unrecognized duration is an error"""
+        code, out, err = self.t.runError("--bucket 5y")
+        self.assertIn("Cannot parse duration '5y'.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
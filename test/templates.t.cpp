@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Templates.h>
+#include <test.h>
+#include <chrono>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string normalized (const std::string& line)
+{
+  std::string output;
+  Templates::normalize (line, output);
+  return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (19);
+
+  t.is (normalized ("took 12ms, 3.5s"),           "took <num>ms, <num>s",     "numbers");
+  t.is (normalized ("from 10.0.0.1:8080"),         "from <ip>:<num>",          "IPv4 address");
+  t.is (normalized ("1.2.3.4.5"),                  "<num>.<num>.<num>",        "not an address");
+  t.is (normalized ("id 550e8400-e29b-41d4-a716-446655440000."), "id <uuid>.", "UUID");
+  t.is (normalized ("at 0x7ffd1c2e, 0X1F"),        "at <hex>, <hex>",          "0x hex");
+  t.is (normalized ("trace 5f3a9c0e12 ok"),        "trace <hex> ok",           "bare hex ID");
+  t.is (normalized ("deadbeefcafe 12345678"),      "deadbeefcafe <num>",       "hex needs letters and digits");
+  t.is (normalized ("user42 v2"),                  "user<num> v<num>",         "digits within words");
+  t.is (normalized (""),                           "",                         "empty");
+  t.ok (normalized (std::string (1000, 'x')).length () == 200, "templates are bounded");
+
+  // Three heavy templates among many distinct ones, in few counters.
+  Templates templates (3);
+  for (int i = 0; i < 100000; ++i)
+  {
+    templates.count ("distinct " + std::to_string (i));
+    if (i % 10 == 0)
+      templates.count ("heavy one");
+    if (i % 20 == 0)
+      templates.count ("heavy two");
+    if (i % 40 == 0)
+      templates.count ("heavy three");
+  }
+
+  t.ok (templates.size () == 1000,                 "memory is bounded");
+
+  auto top = templates.top ();
+  t.ok (top.size () == 3,                          "three shown");
+  t.is (templates.name (top[0]), "heavy one",      "most frequent first");
+  t.is (templates.name (top[1]), "heavy two",      "then second");
+  t.is (templates.name (top[2]), "heavy three",    "then third");
+
+  auto count = templates.count (top[0]);
+  auto error = templates.error (top[0]);
+  t.ok (count >= 10000 && count - error <= 10000,  "count bounds the true count");
+
+  Templates exact (2);
+  exact.count ("a");
+  exact.count ("b");
+  exact.count ("a");
+  t.ok (exact.count (exact.top ()[0]) == 2 && exact.error (exact.top ()[0]) == 0, "exact without eviction");
+
+  // A refresh is due after the interval, however few lines came since.
+  Templates live (2);
+  live.refresh (0.01);
+  std::string output;
+  live.add ("quiet 1", true, output);
+  t.ok (output == "",                              "no table before the interval");
+  std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  live.add ("quiet 2", true, output);
+  t.ok (output.find ("quiet <num>") != std::string::npos, "table after the interval");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+
+class TestThreshold(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+
+    def test_keyed_match(self):
+        """Test coloring only the numbers above a threshold"""
+        self.t.config('default rule "took=" > 500 --> red match')
+        code, out, err = self.t("", input="a took=499 took=512ms\nb took=500\n".encode())
+        self.assertEqual("a took=499 took=\x1b[31m512\x1b[0mms\nb took=500\n", out)
+
+    def test_keyed_decimal(self):
+        """Test comparing decimals and negative numbers"""
+        self.t.config('default rule "load " >= 0.75 --> blue line')
+        self.t.config('default rule "delta=" < -1 --> green line')
+        code, out, err = self.t("", input="load 0.75\nload 0.7\ndelta=-1.5\ndelta=-1\n".encode())
+        self.assertEqual("\x1b[34mload 0.75\x1b[0m\nload 0.7\n\x1b[32mdelta=-1.5\x1b[0m\ndelta=-1\n", out)
+
+    def test_keyed_equality(self):
+        """Test the == and != operators"""
+        self.t.config('default rule "ratio=" == 0.3 --> suppress')
+        self.t.config('default rule "code=" != 200 --> blank')
+        code, out, err = self.t("", input="ratio=0.30\ncode=200\ncode=404\n".encode())
+        self.assertEqual("code=200\n\ncode=404\n\n", out)
+
+    def test_keyed_no_number(self):
+        """Test that a key without a number after it does not match"""
+        self.t.config('default rule "took=" < 5 --> suppress')
+        code, out, err = self.t("", input="took=\ntook=x1\ntook=.5\n".encode())
+        self.assertEqual("took=\ntook=x1\ntook=.5\n", out)
+
+    def test_field_line(self):
+        """Test comparing a whitespace-delimited field"""
+        self.t.config('default rule field 3 >= 500 --> red line')
+        code, out, err = self.t("", input="GET /a 503 12\nGET /b 200 9\nGET\t/c  500\nGET /d\n".encode())
+        self.assertEqual("\x1b[31mGET /a 503 12\x1b[0m\nGET /b 200 9\n\x1b[31mGET\t/c  500\x1b[0m\nGET /d\n", out)
+
+    def test_field_match(self):
+        """Test coloring the number in a field"""
+        self.t.config('default rule field 2 <= 10 --> yellow match')
+        code, out, err = self.t("", input="x 7ms y\nx 11ms y\n".encode())
+        self.assertEqual("x \x1b[33m7\x1b[0mms y\nx 11ms y\n", out)
+
+    def test_malformed(self):
+        """Test that a threshold without a number is not a rule"""
+        self.t.config('default rule "took=" > fast --> suppress')
+        self.t.config('default rule field 0 > 1 --> suppress')
+        code, out, err = self.t("", input="took=9\n".encode())
+        self.assertEqual("took=9\n", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Timestamp.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+void testScan (
+  UnitTest& t,
+  const std::string& line,
+  const std::string& whole,
+  const std::string& clock,
+  long long epoch)
+{
+  Timestamp ts;
+  if (ts.scan (line))
+  {
+    t.is (line.substr (ts._offset, ts._length),      whole, "<" + line + "> timestamp");
+    t.is (line.substr (ts._clock, ts._clockLength),  clock, "<" + line + "> time of day");
+    t.ok (ts.epoch () == epoch,                             "<" + line + "> epoch");
+  }
+  else
+  {
+    t.fail ("<" + line + "> timestamp");
+    t.fail ("<" + line + "> time of day");
+    t.fail ("<" + line + "> epoch");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (24);
+
+  // 2017-06-25 14:03:11 UTC is 1498399391.
+  testScan (t, "at 2017-06-25T14:03:11Z ok",           "2017-06-25T14:03:11Z",       "14:03:11",     1498399391);
+  testScan (t, "2017-06-25T16:03:11.250+02:00 ok",     "2017-06-25T16:03:11.250+02:00", "16:03:11.250", 1498399391);
+  testScan (t, "[2017-06-25 14:03:11] ok",             "2017-06-25 14:03:11",        "14:03:11",     1498399391);
+  testScan (t, "2017/06/25 14:03 [error]",             "2017/06/25 14:03",           "14:03",        1498399380);
+  testScan (t, "- - [25/Jun/2017:07:03:11 -0700] GET", "25/Jun/2017:07:03:11 -0700", "07:03:11",     1498399391);
+  testScan (t, "v2 2017-13-25T14:03:11 25/Jun/2017:14:03:11 x", "25/Jun/2017:14:03:11", "14:03:11", 1498399391);
+
+  Timestamp ts;
+  t.ok (ts.scan ("<13>Jun  5 14:03:11 host su: ok"), "syslog timestamp found");
+  t.is (ts._offset, (size_t) 4,                              "syslog timestamp offset");
+  t.is (ts._length, (size_t) 15,                             "syslog timestamp length");
+  t.is (ts._day, 5,                                  "syslog timestamp day");
+
+  t.notok (ts.scan ("pid 1234 at 12:30, build 2017-06-25"), "no time, no timestamp");
+  t.notok (ts.scan ("id=a2017-06-25T14:03:11"),            "timestamp must start a word");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
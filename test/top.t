@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+from datetime import datetime
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Clog, TestCase
+
+
+
+class TestTop(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Clog()
+        self.t.config('default rule "x" --> suppress')
+
+    def test_top_table(self):
+        """Test the most frequent templates, with numbers masked"""
+        lines = "".join("GET /item/%d took %dms\n" % (i, i * 3) for i in range(5))
+        lines += "login from 10.0.0.%d\n" % 7
+        lines += "login from 10.0.0.%d\n" % 8
+        lines += "cache miss 0x%x\n" % 48879
+        code, out, err = self.t("--top 2", input=lines.encode())
+        rows = out.splitlines()
+        self.assertEqual(4, len(rows))
+        self.assertRegex(rows[0], r"^Count Error +Rate/s Template$")
+        self.assertRegex(rows[1], r"^ +5 +0 +[0-9.]+ GET /item/<num> took <num>ms$")
+        self.assertRegex(rows[2], r"^ +2 +0 +[0-9.]+ login from <ip>$")
+        self.assertEqual("Lines 8", rows[3])
+
+    def test_top_csv(self):
+        """Test the most frequent templates as CSV"""
+        code, out, err = self.t("--top 1 --csv", input="a 1\na 2\nb, \"3\"\nb, \"4\"\nb, \"5\"\n".encode())
+        self.assertEqual('count,error,template\n3,0,"b, ""<num>"""\n', out)
+
+    def test_top_zero(self):
+        """Test that --top needs a count"""
+        code, out, err = self.t.runError("--top 0", input="x\n".encode())
+        self.assertIn("Cannot parse count '0'.", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())